@@ -104,6 +104,7 @@ GLOBOBJS = \
  ns_tandy.obj \
  ns_cd.obj \
  i_debug.obj \
+ i_cpu.obj \
  i_random.obj \
  i_main.obj \
  i_ibm.obj \
@@ -204,8 +205,7 @@ GLOBOBJS = \
  dutils.obj \
  f_wipe.obj \
  info.obj \
- dmx.obj \
- mus2mid.obj
+ dmx.obj
 
 fdoom.exe : $(GLOBOBJS)
 	wlink @fdoom.lnk
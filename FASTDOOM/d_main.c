@@ -48,6 +48,7 @@
 #include "i_system.h"
 #include "i_sound.h"
 #include "i_ibm.h"
+#include "i_cpu.h"
 
 #include "g_game.h"
 
@@ -107,16 +108,22 @@ int spriteRender;
 int pspriteRender;
 int selectedCPU;
 int showFPS;
+boolean showStats;
 int automapRT;
 int debugCardPort;
 boolean debugCardReverse;
 boolean nearSprites;
+boolean mipmapWalls;
+boolean lodSpan;
+boolean deferWalls;
 boolean monoSound;
 boolean noMelt;
 boolean uncappedFPS;
+int autoDetail;
 boolean highResTimer;
 
 boolean reverseStereo;
+boolean resampleSfx;
 
 boolean forceHighDetail;
 boolean forceLowDetail;
@@ -160,6 +167,9 @@ boolean ignoreSoundChecks;
 
 boolean csv;
 boolean disableDemo;
+boolean noDraw;
+boolean noPVS;
+boolean noSoundUpdate;
 
 boolean busSpeed;
 boolean waitVsync;
@@ -219,6 +229,7 @@ void D_DoAdvanceDemo(void);
 event_t events[MAXEVENTS];
 int eventhead;
 int eventtail;
+unsigned int eventcount; // Events handled so far
 
 //
 // D_PostEvent
@@ -241,6 +252,7 @@ void D_ProcessEvents(void)
     for (; eventtail != eventhead; eventtail = (++eventtail) & (MAXEVENTS - 1))
     {
         current_ev = &events[eventtail];
+        eventcount++;
         if (M_Responder())
             continue; // menu ate the event
         G_Responder();
@@ -257,11 +269,43 @@ gamestate_t wipegamestate = GS_DEMOSCREEN;
 extern byte setsizeneeded;
 extern int showMessages;
 
+//
+// D_FrameUnchanged
+// True when drawing again would give the frame already on screen:
+// no tic ran and no event was handled since it was drawn, and the
+// playsim did not advance (paused, menu up) in the tics before it,
+// so every interpolated position equals the current one.
+//
+static boolean D_FrameUnchanged(void)
+{
+    static int framegametic = -1;
+    static int frameleveltime = -1;
+    static unsigned int frameevents;
+    static boolean framefrozen;
+
+    if (gametic != framegametic)
+    {
+        framefrozen = leveltime == frameleveltime;
+        framegametic = gametic;
+        frameleveltime = leveltime;
+        frameevents = eventcount;
+        return false;
+    }
+
+    if (eventcount != frameevents)
+    {
+        frameevents = eventcount;
+        return false;
+    }
+
+    return framefrozen && !setsizeneeded && gamestate == wipegamestate;
+}
+
 
 // Returns whether a frame was drawn. This is used to determine whether to
 // generate a gametic in interpolation mode because we can't deliver
 // a frame in time before we need to generate the next gametic
-void D_Display(void)
+boolean D_Display(void)
 {
     static byte viewactivestate = 0;
     static byte menuactivestate = 0;
@@ -275,6 +319,9 @@ void D_Display(void)
     boolean wipe;
     boolean redrawsbar;
 
+    // Keep the previous frame on screen
+    if (D_FrameUnchanged())
+        return false;
 
     // change the view size if needed
     if (setsizeneeded)
@@ -503,7 +550,7 @@ void D_Display(void)
         if (showFPS)
             I_CalculateFPS();
 
-        return;
+        return true;
     }
 
 // wipe update
@@ -545,6 +592,8 @@ void D_Display(void)
             I_CalculateFPS();
     } while (!done);
 #endif
+
+    return true;
 }
 
 //
@@ -555,6 +604,24 @@ extern byte demorecording;
 unsigned int frametime_position = 0;
 unsigned int *frametime;
 
+//
+// D_UpdateSound
+//
+static void D_UpdateSound(void)
+{
+    S_UpdateSounds(); // move positional sounds
+
+    switch (snd_MusicDevice) // check music track (looping)
+    {
+    case snd_CD:
+        S_CheckCD();
+        break;
+    case snd_WAV:
+        S_CheckWAV();
+        break;
+    }
+}
+
 void D_DoomLoop(void)
 {
     if (demorecording)
@@ -593,17 +660,16 @@ void D_DoomLoop(void)
             TryRunTics(); // will run at least one tic
         }
 
-        S_UpdateSounds(); // move positional sounds
-
-        switch (snd_MusicDevice) // check music track (looping)
+        // Playsim only benchmark, skip everything but the game logic
+        if (noDraw && timingdemo)
         {
-        case snd_CD:
-            S_CheckCD();
-            break;
-        case snd_WAV:
-            S_CheckWAV();
-            break;
+            if (!noSoundUpdate)
+                D_UpdateSound();
+            continue;
         }
+
+        D_UpdateSound();
+
         // Update display, next frame, with current state.
         // If we are in uncapped mode, TryRunTics handles all
         // frame updates since they may be interpolated. However,
@@ -648,20 +714,18 @@ void D_DoomLoopBenchmark(void)
             M_FinishBenchmark();
         }
 
-        S_UpdateSounds(); // move positional sounds
-
-        switch (snd_MusicDevice) // check music track (looping)
+        if (noDraw && timingdemo)
         {
-        case snd_CD:
-            S_CheckCD();
-            break;
-        case snd_WAV:
-            S_CheckWAV();
-            break;
+            if (!noSoundUpdate)
+                D_UpdateSound();
         }
+        else
+        {
+            D_UpdateSound();
 
-        // Update display, next frame, with current state.
-        D_Display();
+            // Update display, next frame, with current state.
+            D_Display();
+        }
 
         end_time = ticcount_hr - start_time;
         // Scale the endtime due to the 560Hz timer
@@ -1525,8 +1589,14 @@ void D_DoomMain(void)
 
     reverseStereo = M_CheckParm("-reverseStereo");
 
+    resampleSfx = M_CheckParm("-resampleSfx");
+
     csv = M_CheckParm("-csv");
 
+    noDraw = M_CheckParm("-nodraw");
+    noPVS = M_CheckParm("-nopvs");
+    noSoundUpdate = M_CheckParm("-nosoundupdate");
+
     benchmark_advanced = M_CheckParm("-advanced");
 
     p = M_CheckParm("-benchmark");
@@ -1594,7 +1664,12 @@ void D_DoomMain(void)
         D_DrawTitle(4);
 
     printf(I_LoadTextProgram(0));
+    I_DetectCPU();
     printf(I_LoadTextProgram(18), I_GetCPUModel());
+    printf(I_LoadTextProgram(228), I_GetCPUVendorName(), cpuinfo.family, cpuinfo.model,
+           I_CPUHasFeature(CPU_FEATURE_FPU) ? " FPU" : "",
+           I_CPUHasFeature(CPU_FEATURE_TSC) ? " TSC" : "",
+           I_CPUHasFeature(CPU_FEATURE_MMX) ? " MMX" : "");
 #if DEBUG_ENABLED == 1
     printf(I_LoadTextProgram(19));
     I_DebugInit();
@@ -1672,6 +1747,12 @@ void D_DoomMain(void)
         screenblocks = forceScreenSize;
     }
 
+    if ((p = M_CheckParm("-autodetail")))
+    {
+        if (p < myargc - 1)
+            autoDetail = atoi(myargv[p + 1]);
+    }
+
     M_CheckParmOptionalValue("-flatSpan", &visplaneRender, VISPLANES_FLAT);
     M_CheckParmOptionalValue("-flatterSpan", &visplaneRender, VISPLANES_FLATTER);
     M_CheckParmOptionalValue("-flatWall", &wallRender, WALL_FLAT);
@@ -1699,6 +1780,9 @@ void D_DoomMain(void)
     M_CheckParmOptionalValue("-debugCard4", &showFPS, DEBUG_CARD_4D_FPS);
     M_CheckParmOptional("-mono", &monoSound);
     M_CheckParmOptional("-near", &nearSprites);
+    M_CheckParmOptional("-mipmap", &mipmapWalls);
+    M_CheckParmOptional("-lodSpan", &lodSpan);
+    M_CheckParmOptional("-deferWalls", &deferWalls);
     M_CheckParmOptional("-nomelt", &noMelt);
     M_CheckParmOptional("-slowbus", &busSpeed);
     M_CheckParmOptional("-vsync", &waitVsync);
@@ -1710,12 +1794,17 @@ void D_DoomMain(void)
     M_CheckParmDisable("-defSky", &flatSky);
     M_CheckParmDisable("-defInv", &invisibleRender);
     M_CheckParmDisable("-far", &nearSprites);
+    M_CheckParmDisable("-nomipmap", &mipmapWalls);
+    M_CheckParmDisable("-nolodSpan", &lodSpan);
+    M_CheckParmDisable("-nodeferWalls", &deferWalls);
     M_CheckParmDisable("-stereo", &monoSound);
     M_CheckParmDisable("-melt", &noMelt);
     M_CheckParmDisable("-fastbus", &busSpeed);
     M_CheckParmDisable("-novsync", &waitVsync);
     M_CheckParmDisable("-capped", &uncappedFPS);
+    M_CheckParmDisable("-noautodetail", &autoDetail);
     M_CheckParmDisable("-nofps", &showFPS);
+    M_CheckParmOptional("-stats", &showStats);
 
 #if defined(MODE_T8025) || defined(MODE_T8050) || defined(MODE_T8043) || defined(MODE_T4025) || defined(MODE_T4050) || defined(MODE_MDA)
     noMelt = 1;
@@ -1739,6 +1828,10 @@ void D_DoomMain(void)
     printf(I_LoadTextProgram(26));
     I_Init();
 
+    // The -stats overlay and the CSV results show the profiled times
+    if (noDraw || showStats || csv)
+        I_StartProfileClock();
+
     printf(I_LoadTextProgram(27));
     S_Init(sfxVolume * 8, musicVolume * 17);
 
@@ -55,7 +55,7 @@ void D_PageDrawer(void);
 void D_AdvanceDemo(void);
 void D_StartTitle(void);
 
-void D_Display(void);
+boolean D_Display(void);
 
 #if defined(MODE_CGA512)
 enum CGA_MODEL
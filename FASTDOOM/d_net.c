@@ -240,12 +240,18 @@ render_frame:
 	}
 	{
 		// Render the frame, recording the frametime_hrticks for the
-		// interpolation of the next frame
+		// interpolation of the next frame. A skipped frame took no
+		// time to draw and says nothing about the next one
 		int last_framets = ticcount_hr;
 		int new_framets;
-		D_Display();
-		new_framets = ticcount_hr;
-		frametime_hrticks = new_framets - last_framets;
+		if (D_Display())
+		{
+			new_framets = ticcount_hr;
+			frametime_hrticks = new_framets - last_framets;
+
+			if (autoDetail > 0)
+				R_GovernDetail(frametime_hrticks);
+		}
 	}
 	return ticks_ran;
 }
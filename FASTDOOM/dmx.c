@@ -23,7 +23,6 @@
 #include "ns_music.h"
 #include "ns_task.h"
 #include "ns_multi.h"
-#include "mus2mid.h"
 #include "ns_pcfx.h"
 #include "doomstat.h"
 #include "ns_scape.h"
@@ -67,65 +66,13 @@ int dmx_snd_port = 0;
 
 int MUS_RegisterSong(void *data)
 {
-    FILE *mus;
-    FILE *mid;
-    unsigned int midlen;
-    unsigned short len;
-    mus_data = NULL;
-    len = ((unsigned short *)data)[2] + ((unsigned short *)data)[3];
     if (mid_data)
     {
         Z_Free(mid_data);
+        mid_data = NULL;
     }
-    if (memcmp(data, "MThd", 4))
-    {
-        mus = fopen("temp.mus", "wb");
-        if (!mus)
-        {
-            return 0;
-        }
-        fwrite(data, 1, len, mus);
-        fclose(mus);
-        mus = fopen("temp.mus", "rb");
-        if (!mus)
-        {
-            return 0;
-        }
-        mid = fopen("temp.mid", "wb");
-        if (!mid)
-        {
-            fclose(mus);
-            return 0;
-        }
-        if (mus2mid(mus, mid))
-        {
-            fclose(mid);
-            fclose(mus);
-            return 0;
-        }
-        fclose(mid);
-        fclose(mus);
-        mid = fopen("temp.mid", "rb");
-        if (!mid)
-        {
-            return 0;
-        }
-        fseek(mid, 0, SEEK_END);
-        midlen = ftell(mid);
-        rewind(mid);
-        mid_data = Z_MallocUnowned(midlen, PU_STATIC);
-        if (!mid_data)
-        {
-            fclose(mid);
-            return 0;
-        }
-        fread(mid_data, 1, midlen, mid);
-        fclose(mid);
-        mus_data = mid_data;
-        remove("temp.mid");
-        remove("temp.mus");
-        return 0;
-    }
+
+    // MUS scores are decoded by the MIDI player itself
     mus_data = data;
     return 0;
 }
@@ -352,8 +299,9 @@ int MUS_LoadMT32(void)
     if (mid_data)
     {
         Z_Free(mid_data);
+        mid_data = NULL;
     }
-        
+
     mid = fopen(mt32file, "rb");
     if (!mid)
     {
@@ -381,6 +329,7 @@ void MUS_ReleaseData(void)
         if (mid_data)
         {
             Z_Free(mid_data);
+            mid_data = NULL;
         }
     }
 }
@@ -443,6 +392,85 @@ int SFX_PlayPatch(void *vdata, int sep, int vol)
 
     return -1;
 }
+//
+// SFX_ResamplePatch
+// Converts a digital sound lump to the mix rate, stepping through the
+// samples like the mixer does, so it can be mixed without resampling.
+// Returns NULL if the sound doesn't need it.
+//
+void *SFX_ResamplePatch(void *vdata)
+{
+    unsigned char *data = (unsigned char *)vdata;
+    unsigned char *resampled;
+    unsigned char *src;
+    unsigned char *dest;
+    unsigned int type = data[0] | (data[1] << 8);
+    unsigned int rate;
+    unsigned int mixrate;
+    unsigned long len;
+    unsigned long newlen;
+    unsigned long step;
+    unsigned long frac;
+    unsigned long srcpos;
+    unsigned long i;
+
+    if (type != 3)
+    {
+        return NULL;
+    }
+
+    rate = (data[3] << 8) | data[2];
+    len = (data[7] << 24) | (data[6] << 16) | (data[5] << 8) | data[4];
+    mixrate = MV_GetMixRate();
+
+    if (len <= 48 || mixrate == 0 || rate == mixrate)
+    {
+        return NULL;
+    }
+
+    len -= 32;
+
+    step = ((unsigned long)rate << 16) / mixrate;
+    newlen = (len / rate) * mixrate + ((len % rate) * mixrate) / rate;
+
+    // Same layout as the lump: 8 byte header, 16 bytes of padding
+    // before and after the samples
+    resampled = Z_MallocUnowned(24 + newlen + 16, PU_SOUND);
+
+    resampled[0] = 3;
+    resampled[1] = 0;
+    resampled[2] = mixrate & 0xFF;
+    resampled[3] = mixrate >> 8;
+    resampled[4] = (newlen + 32) & 0xFF;
+    resampled[5] = ((newlen + 32) >> 8) & 0xFF;
+    resampled[6] = ((newlen + 32) >> 16) & 0xFF;
+    resampled[7] = (newlen + 32) >> 24;
+
+    memset(resampled + 8, 0x80, 16);
+    memset(resampled + 24 + newlen, 0x80, 16);
+
+    src = data + 24;
+    dest = resampled + 24;
+    srcpos = 0;
+    frac = 0;
+
+    for (i = 0; i < newlen && srcpos < len; i++)
+    {
+        dest[i] = src[srcpos];
+
+        frac += step;
+        srcpos += frac >> 16;
+        frac &= 0xFFFF;
+    }
+
+    for (; i < newlen; i++)
+    {
+        dest[i] = 0x80;
+    }
+
+    return resampled;
+}
+
 void SFX_StopPatch(int handle)
 {
     if (handle & 0x8000)
@@ -37,6 +37,7 @@ void MUS_TextMU80(unsigned char *text, int size);
 void MUS_ImgTG300(void);
 void MUS_TextTG300(unsigned char *text, int size);
 int SFX_PlayPatch(void *vdata, int sep, int vol);
+void *SFX_ResamplePatch(void *vdata);
 void SFX_StopPatch(int handle);
 int SFX_Playing(int handle);
 void SFX_SetOrigin(int handle, int sep, int vol);
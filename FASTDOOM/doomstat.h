@@ -50,14 +50,19 @@ extern int spriteRender;
 extern int pspriteRender;
 extern int selectedCPU;
 extern int showFPS;
+extern boolean showStats;
 extern int automapRT;
 extern int debugCardPort;
 extern boolean debugCardReverse;
 extern boolean nearSprites;
+extern boolean mipmapWalls;
+extern boolean lodSpan;
+extern boolean deferWalls;
 extern boolean monoSound;
 extern boolean noMelt;
 
 extern boolean reverseStereo;
+extern boolean resampleSfx;
 
 extern boolean forceHighDetail;
 extern boolean forceLowDetail;
@@ -101,10 +106,14 @@ extern boolean ignoreSoundChecks;
 
 extern boolean csv;
 extern boolean disableDemo;
+extern boolean noDraw;
+extern boolean noPVS;
+extern boolean noSoundUpdate;
 
 extern boolean busSpeed;
 extern boolean waitVsync;
 extern boolean uncappedFPS;
+extern int autoDetail; // Frame rate held by lowering the detail, 0 = off
 extern boolean highResTimer;
 
 // Set if homebrew PWAD stuff has been added.
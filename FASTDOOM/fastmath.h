@@ -54,6 +54,15 @@ fixed_t FixedMulEDXHalf(fixed_t a, fixed_t b);
     "imul edx",        \
     "shrd eax,edx,17" parm[eax][edx] value[eax] modify exact[eax edx]
 
+// One Newton-Raphson step refining r towards 2^32 / d.
+// Only converges when r is already within a few percent.
+unsigned int ReciprocalNewton(unsigned int r, unsigned int d);
+#pragma aux ReciprocalNewton = \
+    "mov eax, ebx",    \
+    "imul eax, ecx",   \
+    "imul ebx",        \
+    "sub ebx, edx" parm[ebx][ecx] value[ebx] modify exact[eax ebx edx]
+
 fixed_t FixedMulSquare(fixed_t a);
 #pragma aux FixedMulSquare = \
     "imul eax",        \
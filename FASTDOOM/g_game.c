@@ -67,6 +67,11 @@
 
 #include "i_file.h"
 #include "i_debug.h"
+#include "i_cpu.h"
+#include "ns_midi.h"
+#include "ns_sbmus.h"
+#include "ns_task.h"
+#include "ns_multi.h"
 
 #define SAVEGAMESIZE 0x2c000
 #define SAVESTRINGSIZE 24
@@ -356,6 +361,11 @@ void G_DoLoadLevel(void)
         players.playerstate = PST_REBORN;
 
     P_SetupLevel(gameepisode, gamemap, 0, gameskill);
+    P_ResetPlaysimProfile();
+    memset(&MIDI_ISRProfile, 0, sizeof(MIDI_ISRProfile));
+    memset(&TS_ISRProfile, 0, sizeof(TS_ISRProfile));
+    memset(&MV_ISRProfile, 0, sizeof(MV_ISRProfile));
+    AL_PortWrites = AL_SkippedWrites = AL_DelayReads = 0;
     starttime = ticcount;
     gameaction = ga_nothing;
 
@@ -920,6 +930,7 @@ int G_CalculateSaveGameSize(void)
             savesize += sizeof(mobj_t);
 		}
     }
+    savesize += numstaticthinkers * (1 + 3 + sizeof(mobj_t));
     savesize += 1;
 
     // P_ArchiveSpecials
@@ -1439,9 +1450,24 @@ void G_CreateCSV(void)
     fclose(fptr);
 }
 
+//
+// G_SaveCSVProfile
+// Writes the entries and the worst case time of an interrupt handler.
+//
+static void G_SaveCSVProfile(FILE *logFile, isrprofile_t *profile)
+{
+    unsigned int ms, frac;
+
+    fprintf(logFile, "%u" CSV_COLUMN, profile->entries);
+    I_ProfileClockToMs(profile->worst, &ms, &frac);
+    fprintf(logFile, "%u" CSV_DECIMAL "%.3u", ms, frac);
+}
+
 void G_SaveCSVResult(unsigned int gametics, unsigned int realtics, unsigned int resultfps, unsigned int onepercentlow, unsigned int dotonepercentlow)
 {
     FILE *logFile = fopen(CSV_FILE, "a");
+    unsigned int ms, frac;
+
     if (logFile)
     {
         // Executable
@@ -1615,7 +1641,45 @@ void G_SaveCSVResult(unsigned int gametics, unsigned int realtics, unsigned int
         fprintf(logFile, "%u" CSV_DECIMAL "%.3u" CSV_COLUMN, onepercentlow / 1000, onepercentlow % 1000);
 
         // 0.1% low FPS
-        fprintf(logFile, "%u" CSV_DECIMAL "%.3u\n", dotonepercentlow / 1000, dotonepercentlow % 1000);
+        fprintf(logFile, "%u" CSV_DECIMAL "%.3u" CSV_COLUMN, dotonepercentlow / 1000, dotonepercentlow % 1000);
+
+        // Playsim only, FPS is tics per second
+        if (noDraw)
+            fprintf(logFile, "yes");
+        else
+            fprintf(logFile, "no");
+
+        fprintf(logFile, CSV_COLUMN);
+
+        // Time spent per subsystem (milliseconds)
+        I_ProfileClockToMs(playerthinktime, &ms, &frac);
+        fprintf(logFile, "%u" CSV_DECIMAL "%.3u" CSV_COLUMN, ms, frac);
+        I_ProfileClockToMs(runthinkerstime, &ms, &frac);
+        fprintf(logFile, "%u" CSV_DECIMAL "%.3u" CSV_COLUMN, ms, frac);
+        I_ProfileClockToMs(updatespecialstime, &ms, &frac);
+        fprintf(logFile, "%u" CSV_DECIMAL "%.3u" CSV_COLUMN, ms, frac);
+
+        // Sight checks
+        fprintf(logFile, "%u" CSV_COLUMN "%u" CSV_COLUMN "%u" CSV_COLUMN "%u" CSV_COLUMN, sightchecks, sightrejects, sightwalks, sightcachehits);
+
+        // Time spent in the MIDI interrupt (milliseconds)
+        I_ProfileClockToMs(MIDI_ISRProfile.time, &ms, &frac);
+        fprintf(logFile, "%u" CSV_DECIMAL "%.3u" CSV_COLUMN, ms, frac);
+
+        // OPL register writes
+        fprintf(logFile, "%u" CSV_COLUMN "%u" CSV_COLUMN "%u" CSV_COLUMN, AL_PortWrites, AL_SkippedWrites, AL_DelayReads);
+
+        // Interrupt handlers: MIDI runs inside the timer interrupt
+        G_SaveCSVProfile(logFile, &MIDI_ISRProfile);
+        fprintf(logFile, CSV_COLUMN);
+        I_ProfileClockToMs(TS_ISRProfile.time, &ms, &frac);
+        fprintf(logFile, "%u" CSV_DECIMAL "%.3u" CSV_COLUMN, ms, frac);
+        G_SaveCSVProfile(logFile, &TS_ISRProfile);
+        fprintf(logFile, CSV_COLUMN);
+        I_ProfileClockToMs(MV_ISRProfile.time, &ms, &frac);
+        fprintf(logFile, "%u" CSV_DECIMAL "%.3u" CSV_COLUMN, ms, frac);
+        G_SaveCSVProfile(logFile, &MV_ISRProfile);
+        fprintf(logFile, "\n");
 
         fclose(logFile);
     }
@@ -1770,6 +1834,20 @@ void G_CheckDemoStatus(void)
 
             benchmark_finished = true;
         }
+        else if (noDraw)
+        {
+            unsigned int playerms, playerfrac;
+            unsigned int thinkersms, thinkersfrac;
+            unsigned int specialsms, specialsfrac;
+
+            I_ProfileClockToMs(playerthinktime, &playerms, &playerfrac);
+            I_ProfileClockToMs(runthinkerstime, &thinkersms, &thinkersfrac);
+            I_ProfileClockToMs(updatespecialstime, &specialsms, &specialsfrac);
+
+            I_Error(31, gametics, realtics, resultfps / 1000, resultfps % 1000,
+                    playerms, playerfrac, thinkersms, thinkersfrac, specialsms, specialsfrac,
+                    sightchecks, sightrejects, sightwalks, sightcachehits);
+        }
         else
         {
             I_Error(17, gametics, realtics, resultfps / 1000, resultfps % 1000);
@@ -31,6 +31,7 @@
 #include "s_sound.h"
 
 #include "doomstat.h"
+#include "p_local.h"
 
 // Data.
 #include "dstrings.h"
@@ -38,6 +39,11 @@
 
 #include "options.h"
 
+#include "i_ibm.h"
+#include "ns_task.h"
+#include "ns_midi.h"
+#include "ns_multi.h"
+
 //
 // Locally used constants, shortcuts.
 //
@@ -52,9 +58,14 @@
 #define HU_INPUTWIDTH 64
 #define HU_INPUTHEIGHT 1
 
+#define HU_STATSX 0
+#define HU_STATSY(x) (HU_MSGY + 8 * ((x) + 1))
+#define HU_STATSLINES 4
+
 patch_t *hu_font[HU_FONTSIZE];
 static hu_textline_t w_title;
 static hu_textline_t w_fps;
+static hu_textline_t w_stats[HU_STATSLINES];
 
 static byte message_on;
 byte message_dontfuckwithme;
@@ -106,6 +117,14 @@ void HU_Start(void)
                        hu_font,
                        HU_FONTSTART);
 
+    for (i = 0; i < HU_STATSLINES; i++)
+    {
+        HUlib_initTextLine(&w_stats[i],
+                           HU_STATSX, HU_STATSY(i),
+                           hu_font,
+                           HU_FONTSTART);
+    }
+
     // create the map title widget
     HUlib_initTextLine(&w_title,
                        HU_TITLEX, HU_TITLEY,
@@ -148,6 +167,77 @@ void HU_DrawScreenFPS(void)
 #endif
 }
 
+// Share of the CPU taken by the sound interrupts, refreshed every second
+#define HU_NUMISRS 3
+
+static isrprofile_t *const isrprofiles[HU_NUMISRS] = {&TS_ISRProfile, &MIDI_ISRProfile, &MV_ISRProfile};
+static unsigned int isrlasttime[HU_NUMISRS];
+static unsigned int isrload[HU_NUMISRS]; // Tenths of a percent
+static unsigned int isrlasttics;
+
+static void HU_UpdateISRLoad(void)
+{
+    int i;
+    unsigned int elapsed;
+    unsigned int time;
+    unsigned int ms, frac;
+
+    if (ticcount - isrlasttics < TICRATE)
+        return;
+
+    elapsed = (ticcount - isrlasttics) * 1000 / TICRATE;
+    isrlasttics = ticcount;
+
+    for (i = 0; i < HU_NUMISRS; i++)
+    {
+        time = isrprofiles[i]->time;
+
+        // The profiles are cleared when a level starts
+        if (time >= isrlasttime[i])
+            I_ProfileClockToMs(time - isrlasttime[i], &ms, &frac);
+        else
+            I_ProfileClockToMs(time, &ms, &frac);
+
+        isrlasttime[i] = time;
+        isrload[i] = (ms * 1000 + frac) / elapsed;
+    }
+}
+
+static void HU_DrawStatsLine(int line, char *s)
+{
+    HUlib_clearTextLine(&w_stats[line]);
+    while (*s)
+    {
+        HUlib_addCharToTextLine(&w_stats[line], *(s++));
+    }
+    HUlib_drawTextLine(&w_stats[line]);
+}
+
+void HU_DrawStats(void)
+{
+    char str[HU_MAXLINELENGTH + 1];
+
+    sprintf(str, "THINKERS %d STATIC %d DORMANT %d", numrunthinkers, numstaticthinkers, numdormantthinkers);
+    HU_DrawStatsLine(0, str);
+
+    sprintf(str, "FLATS %dK SOUNDS %dK", flatmemory >> 10, sfxmemory >> 10);
+    HU_DrawStatsLine(1, str);
+
+    HU_UpdateISRLoad();
+    sprintf(str, "ISR TIMER %d.%d%% MIDI %d.%d%% SFX %d.%d%%",
+            isrload[0] / 10, isrload[0] % 10,
+            isrload[1] / 10, isrload[1] % 10,
+            isrload[2] / 10, isrload[2] % 10);
+    HU_DrawStatsLine(2, str);
+
+    sprintf(str, "BSP NODES %d SUBSECTORS %d%s", bspnodesvisited, bspsubsectorsvisited, viewclosed ? " CLOSED" : "");
+    HU_DrawStatsLine(3, str);
+
+#if defined(USE_BACKBUFFER)
+    updatestate |= I_MESSAGES;
+#endif
+}
+
 void HU_DrawDebugCard2DigitsFPS(void)
 {
     unsigned int outfps = fps;
@@ -229,6 +319,9 @@ void HU_Drawer(void)
         break;
     }
 
+    if (showStats)
+        HU_DrawStats();
+
 #if defined(MODE_X) || defined(MODE_Y) || defined(MODE_Y_HALF) || defined(USE_BACKBUFFER) || defined(MODE_VBE2_DIRECT)
     if (automapactive)
         HUlib_drawTextLine(&w_title);
@@ -237,10 +330,14 @@ void HU_Drawer(void)
 
 void HU_Erase(void)
 {
+    int i;
 
     HUlib_eraseSText(&w_message);
     HUlib_eraseTextLine(&w_title);
     HUlib_eraseTextLine(&w_fps);
+
+    for (i = 0; i < HU_STATSLINES; i++)
+        HUlib_eraseTextLine(&w_stats[i]);
 }
 
 void HU_Ticker(void)
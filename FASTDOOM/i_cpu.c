@@ -0,0 +1,407 @@
+//
+// Copyright (C) 1993-1996 Id Software, Inc.
+// Copyright (C) 1993-2008 Raven Software
+// Copyright (C) 2016-2017 Alexey Khokholov (Nuke.YKT)
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//  CPU vendor, family and feature detection.
+//  386 and 486 are told apart with the EFLAGS AC bit, CPUID
+//  availability with the EFLAGS ID bit. Cyrix parts usually ship
+//  with CPUID disabled, so they are identified with the 5/2 division
+//  test and the DIR0 configuration register instead.
+//  Also provides the clock used to profile engine subsystems and
+//  interrupt handlers, the TSC or the PIT when there is no TSC.
+//
+
+#include <string.h>
+#include <conio.h>
+
+#include "doomtype.h"
+#include "doomdef.h"
+#include "ns_inter.h"
+#include "ns_task.h"
+#include "i_cpu.h"
+#include "i_ibm.h"
+
+#define EFLAGS_AC 0x00040000
+#define EFLAGS_ID 0x00200000
+
+#define CYRIX_INDEX 0x22
+#define CYRIX_DATA 0x23
+#define CYRIX_DIR0 0xFE
+
+#define PROFILE_CALIBRATION_TICS 8
+#define PROFILE_MAX_RATE 2000000
+
+#define PIT_CLOCK_RATE 1193182
+
+cpuinfo_t cpuinfo;
+
+unsigned int profileclockrate;
+boolean profiling;
+static byte profileclockshift;
+static boolean profileclocktsc;
+
+// Returns the bits of mask that could be toggled in EFLAGS.
+// The original EFLAGS are restored before returning.
+static unsigned int I_ToggleEFLAGS(unsigned int mask);
+#pragma aux I_ToggleEFLAGS = \
+    "pushfd",                \
+    "pop eax",               \
+    "mov ecx, eax",          \
+    "xor eax, edx",          \
+    "push eax",              \
+    "popfd",                 \
+    "pushfd",                \
+    "pop eax",               \
+    "push ecx",              \
+    "popfd",                 \
+    "xor eax, ecx",          \
+    "and eax, edx" parm[edx] value[eax] modify[ecx];
+
+static void I_CPUID(unsigned int leaf, unsigned int *result);
+#pragma aux I_CPUID =        \
+    "cpuid",                 \
+    "mov [esi], eax",        \
+    "mov [esi+4], ebx",      \
+    "mov [esi+8], ecx",      \
+    "mov [esi+12], edx" parm[eax][esi] modify[eax ebx ecx edx];
+
+// Cyrix processors leave the flags untouched after a DIV,
+// other vendors modify the undefined ones.
+static int I_CyrixDivisionTest(void);
+#pragma aux I_CyrixDivisionTest = \
+    "xor ax, ax",            \
+    "sahf",                  \
+    "mov ax, 5",             \
+    "mov bl, 2",             \
+    "div bl",                \
+    "lahf",                  \
+    "xor ecx, ecx",          \
+    "cmp ah, 2",             \
+    "sete cl",               \
+    "mov eax, ecx" value[eax] modify[ebx ecx];
+
+// Low 16 bits of CR0, readable from any privilege level
+static unsigned short I_ReadMSW(void);
+#pragma aux I_ReadMSW = \
+    "smsw ax" value[ax];
+
+#define MSW_EM 0x0004
+
+// Status word in the low half, control word in the high half.
+// Without a x87 nothing is stored and the 0x5A5A pattern is kept.
+static unsigned int I_ProbeFPUWords(void);
+#pragma aux I_ProbeFPUWords = \
+    "push 0x5A5A5A5A",       \
+    "fninit",                \
+    "fnstsw word ptr [esp]", \
+    "fnstcw word ptr [esp+2]", \
+    "pop eax" value[eax];
+
+// Low 32 bits of the TSC after shifting it right
+static unsigned int I_ReadTSC(byte shift);
+#pragma aux I_ReadTSC =      \
+    "rdtsc",                 \
+    "shrd eax, edx, cl" parm[cl] value[eax] modify[edx];
+
+static boolean I_ProbeFPU(void)
+{
+    unsigned int words;
+
+    // With EM set every x87 instruction traps to the emulator
+    if (I_ReadMSW() & MSW_EM)
+        return false;
+
+    words = I_ProbeFPUWords();
+
+    if ((words & 0xFF) != 0)
+        return false;
+
+    return ((words >> 16) & 0x103F) == 0x003F;
+}
+
+static byte I_ReadCyrixRegister(byte reg)
+{
+    unsigned long flags;
+    byte value;
+
+    flags = DisableInterrupts();
+    outp(CYRIX_INDEX, reg);
+    value = inp(CYRIX_DATA);
+    RestoreInterrupts(flags);
+
+    return value;
+}
+
+static void I_DetectCyrix(void)
+{
+    byte dir0;
+
+    cpuinfo.vendor = CPU_VENDOR_CYRIX;
+
+    dir0 = I_ReadCyrixRegister(CYRIX_DIR0);
+
+    // An unconnected port reads back as 0xFF
+    if (dir0 == 0xFF)
+        return;
+
+    cpuinfo.cyrixdir0 = dir0;
+
+    if (cpuinfo.hascpuid)
+        return;
+
+    if (dir0 < 0x28)
+        cpuinfo.family = 4; // Cx486SLC/DLC, Cx486S, Cx486DX/DX2/DX4
+    else if (dir0 < 0x30)
+    {
+        cpuinfo.family = 4; // 5x86 reports itself as a 486 through CPUID
+        cpuinfo.model = 9;
+    }
+    else if (dir0 < 0x50)
+        cpuinfo.family = 5; // 6x86, MediaGX
+    else if (dir0 < 0x60)
+        cpuinfo.family = 6; // 6x86MX, MII
+}
+
+static void I_DetectVendor(void)
+{
+    if (!strcmp(cpuinfo.vendorid, "GenuineIntel"))
+        cpuinfo.vendor = CPU_VENDOR_INTEL;
+    else if (!strcmp(cpuinfo.vendorid, "AuthenticAMD") || !strcmp(cpuinfo.vendorid, "AMDisbetter!"))
+        cpuinfo.vendor = CPU_VENDOR_AMD;
+    else if (!strcmp(cpuinfo.vendorid, "CyrixInstead"))
+        cpuinfo.vendor = CPU_VENDOR_CYRIX;
+    else if (!strcmp(cpuinfo.vendorid, "UMC UMC UMC "))
+        cpuinfo.vendor = CPU_VENDOR_UMC;
+    else if (!strcmp(cpuinfo.vendorid, "NexGenDriven"))
+        cpuinfo.vendor = CPU_VENDOR_NEXGEN;
+    else if (!strcmp(cpuinfo.vendorid, "CentaurHauls"))
+        cpuinfo.vendor = CPU_VENDOR_CENTAUR;
+    else if (!strcmp(cpuinfo.vendorid, "RiseRiseRise"))
+        cpuinfo.vendor = CPU_VENDOR_RISE;
+    else
+        cpuinfo.vendor = CPU_VENDOR_UNKNOWN;
+}
+
+void I_DetectCPU(void)
+{
+    unsigned int regs[4];
+
+    memset(&cpuinfo, 0, sizeof(cpuinfo));
+
+    if (!I_ToggleEFLAGS(EFLAGS_AC))
+    {
+        cpuinfo.family = 3;
+    }
+    else
+    {
+        cpuinfo.family = 4;
+        cpuinfo.hascpuid = I_ToggleEFLAGS(EFLAGS_ID) != 0;
+    }
+
+    if (cpuinfo.hascpuid)
+    {
+        I_CPUID(0, regs);
+
+        memcpy(cpuinfo.vendorid, &regs[1], 4);
+        memcpy(cpuinfo.vendorid + 4, &regs[3], 4);
+        memcpy(cpuinfo.vendorid + 8, &regs[2], 4);
+        cpuinfo.vendorid[12] = '\0';
+
+        I_DetectVendor();
+
+        if (regs[0] >= 1)
+        {
+            I_CPUID(1, regs);
+
+            cpuinfo.stepping = regs[0] & 0xF;
+            cpuinfo.model = (regs[0] >> 4) & 0xF;
+            cpuinfo.family = (regs[0] >> 8) & 0xF;
+
+            if (cpuinfo.family == 0xF)
+                cpuinfo.family += (regs[0] >> 20) & 0xFF;
+
+            cpuinfo.features = regs[3];
+        }
+
+        if (cpuinfo.vendor == CPU_VENDOR_CYRIX)
+            I_DetectCyrix();
+    }
+    else if (I_CyrixDivisionTest())
+    {
+        I_DetectCyrix();
+    }
+
+    if (!cpuinfo.hascpuid && I_ProbeFPU())
+        cpuinfo.features |= CPU_FEATURE_FPU;
+}
+
+cpu_t I_GetDetectedCPU(void)
+{
+    if (cpuinfo.family <= 3)
+        return INTEL_386SX;
+
+    switch (cpuinfo.vendor)
+    {
+    case CPU_VENDOR_CYRIX:
+        if (cpuinfo.cyrixdir0 != 0 && cpuinfo.cyrixdir0 < 0x08)
+            return CYRIX_386DLC;
+        if ((cpuinfo.family == 4 && cpuinfo.model == 9) || (cpuinfo.cyrixdir0 >= 0x28 && cpuinfo.cyrixdir0 < 0x30))
+            return CYRIX_5X86;
+        if (cpuinfo.family == 4)
+            return CYRIX_486;
+        return INTEL_PENTIUM; // 6x86, 6x86MX, MII, MediaGX
+    case CPU_VENDOR_UMC:
+        return UMC_GREEN_486;
+    case CPU_VENDOR_AMD:
+        if (cpuinfo.family == 4)
+            return INTEL_486;
+        if (cpuinfo.family == 5 && cpuinfo.model <= 3)
+            return AMD_K5;
+        return INTEL_PENTIUM; // K6 and later
+    default:
+        if (cpuinfo.family == 4)
+            return INTEL_486;
+        return INTEL_PENTIUM;
+    }
+}
+
+const char *I_GetCPUVendorName(void)
+{
+    switch (cpuinfo.vendor)
+    {
+    case CPU_VENDOR_INTEL:
+        return "Intel";
+    case CPU_VENDOR_AMD:
+        return "AMD";
+    case CPU_VENDOR_CYRIX:
+        return "Cyrix";
+    case CPU_VENDOR_UMC:
+        return "UMC";
+    case CPU_VENDOR_NEXGEN:
+        return "NexGen";
+    case CPU_VENDOR_CENTAUR:
+        return "Centaur";
+    case CPU_VENDOR_RISE:
+        return "Rise";
+    default:
+        return "Unknown";
+    }
+}
+
+//
+// I_StartProfileClock
+// Must be called with the timer already running.
+//
+void I_StartProfileClock(void)
+{
+    volatile unsigned int *tics;
+    unsigned int tic;
+    unsigned int start;
+    unsigned int rate;
+
+    profiling = true;
+
+    if (!I_CPUHasFeature(CPU_FEATURE_TSC))
+    {
+        profileclocktsc = false;
+        profileclockrate = PIT_CLOCK_RATE;
+        return;
+    }
+
+    // Measure the TSC against the 35Hz timer. Only the timer
+    // interrupt changes ticcount, so it has to be read again
+    // on every pass
+    tics = &ticcount;
+
+    tic = *tics;
+    while (*tics == tic)
+        ;
+
+    start = I_ReadTSC(0);
+    tic = *tics + PROFILE_CALIBRATION_TICS;
+    while (*tics != tic)
+        ;
+
+    rate = (I_ReadTSC(0) - start) / PROFILE_CALIBRATION_TICS * 35;
+
+    // Scale the clock down so long runs don't overflow the accumulators
+    profileclockshift = 0;
+    while ((rate >> profileclockshift) > PROFILE_MAX_RATE)
+        profileclockshift++;
+
+    profileclockrate = rate >> profileclockshift;
+    profileclocktsc = true;
+}
+
+unsigned int I_ReadProfileClock(void)
+{
+    if (!profileclocktsc)
+        return TS_ReadPITClock();
+
+    return I_ReadTSC(profileclockshift);
+}
+
+//
+// I_ProfileClockToMs
+// Converts profiling clock ticks to milliseconds and thousandths.
+//
+void I_ProfileClockToMs(unsigned int ticks, unsigned int *ms, unsigned int *frac)
+{
+    unsigned int rem;
+
+    if (profileclockrate == 0)
+    {
+        *ms = 0;
+        *frac = 0;
+        return;
+    }
+
+    rem = ticks % profileclockrate;
+    *ms = (ticks / profileclockrate) * 1000 + (rem * 1000) / profileclockrate;
+    *frac = (((rem * 1000) % profileclockrate) * 1000) / profileclockrate;
+}
+
+//
+// I_StartProfileISR
+// Returns the start of a run of an interrupt handler. Without
+// profiling the clock is not read at all.
+//
+unsigned int I_StartProfileISR(void)
+{
+    if (!profiling)
+        return 0;
+
+    return I_ReadProfileClock();
+}
+
+//
+// I_EndProfileISR
+// Accounts a run of an interrupt handler that started at start.
+//
+void I_EndProfileISR(isrprofile_t *profile, unsigned int start)
+{
+    unsigned int time;
+
+    if (!profiling)
+        return;
+
+    time = I_ReadProfileClock() - start;
+
+    profile->entries++;
+    profile->time += time;
+
+    if (time > profile->worst)
+        profile->worst = time;
+}
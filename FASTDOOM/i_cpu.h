@@ -0,0 +1,86 @@
+//
+// Copyright (C) 1993-1996 Id Software, Inc.
+// Copyright (C) 1993-2008 Raven Software
+// Copyright (C) 2016-2017 Alexey Khokholov (Nuke.YKT)
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//  CPU vendor, family and feature detection.
+//
+
+#ifndef __I_CPU__
+#define __I_CPU__
+
+#include "doomtype.h"
+#include "doomdef.h"
+
+typedef enum
+{
+    CPU_VENDOR_UNKNOWN,
+    CPU_VENDOR_INTEL,
+    CPU_VENDOR_AMD,
+    CPU_VENDOR_CYRIX,
+    CPU_VENDOR_UMC,
+    CPU_VENDOR_NEXGEN,
+    CPU_VENDOR_CENTAUR,
+    CPU_VENDOR_RISE,
+    NUM_CPU_VENDOR
+} cpuvendor_t;
+
+// CPUID standard feature flags (EDX of leaf 1)
+#define CPU_FEATURE_FPU 0x00000001
+#define CPU_FEATURE_TSC 0x00000010
+#define CPU_FEATURE_CX8 0x00000100
+#define CPU_FEATURE_CMOV 0x00008000
+#define CPU_FEATURE_MMX 0x00800000
+
+typedef struct
+{
+    cpuvendor_t vendor;
+    int family;       // 3 = 386, 4 = 486, 5 = 586, 6 = 686
+    int model;
+    int stepping;
+    unsigned int features;
+    boolean hascpuid;
+    byte cyrixdir0;   // Cyrix DIR0 device id, 0 if not available
+    char vendorid[13];
+} cpuinfo_t;
+
+extern cpuinfo_t cpuinfo;
+
+void I_DetectCPU(void);
+cpu_t I_GetDetectedCPU(void);
+const char *I_GetCPUVendorName(void);
+
+#define I_CPUHasFeature(x) ((cpuinfo.features & (x)) != 0)
+
+// Profiling clock. Runs from the TSC when the CPU has one, scaled
+// down to a few MHz, otherwise from the 1.19MHz PIT.
+extern unsigned int profileclockrate; // Ticks per second
+extern boolean profiling; // Set by I_StartProfileClock
+
+void I_StartProfileClock(void);
+unsigned int I_ReadProfileClock(void);
+void I_ProfileClockToMs(unsigned int ticks, unsigned int *ms, unsigned int *frac);
+
+// Time spent in an interrupt handler, in profiling clock ticks
+typedef struct
+{
+    unsigned int entries;
+    unsigned int time;
+    unsigned int worst;
+} isrprofile_t;
+
+unsigned int I_StartProfileISR(void);
+void I_EndProfileISR(isrprofile_t *profile, unsigned int start);
+
+#endif
@@ -37,6 +37,7 @@
 #include "z_zone.h"
 #include "ns_dpmi.h"
 #include "ns_task.h"
+#include "ns_irq.h"
 #include "doomdef.h"
 #include "doomstat.h"
 #include "ns_inter.h"
@@ -53,6 +54,7 @@
 
 #include "i_gamma.h"
 #include "i_file.h"
+#include "i_cpu.h"
 
 #if defined(MODE_CGA_AFH)
 #include "i_cgaafh.h"
@@ -983,6 +985,95 @@ void I_ShutdownKeyboard(void)
 // Mouse
 //
 
+// The driver reports movement and button changes through an event
+// handler, reached with a DPMI real mode callback. I_ReadMouse then
+// only reads memory instead of calling int 33h twice per tic.
+static dpmiregs_t mouseregs;
+static volatile unsigned short mousebuttons;
+static volatile short mousemickeys;
+static short lastmousemickeys;
+
+static byte mousecallback;
+static unsigned short mousecallbackseg;
+static unsigned short mousecallbackoff;
+
+#pragma aux I_MouseEvent parm[];
+
+static void I_MouseEvent(unsigned short _far *stkp)
+{
+    // "Pop" the far return address of the driver
+    // so it resumes where it left off
+    mouseregs.ip = *stkp++;
+    mouseregs.cs = *stkp++;
+
+    mouseregs.sp = FP_OFF(stkp);
+
+    mousebuttons = mouseregs.ebx;
+    mousemickeys = mouseregs.esi; // running horizontal mickey count
+}
+
+static void _interrupt _cdecl I_MouseCallback(
+    // regs pushed in this order by prologue
+
+    int rgs,
+    int rfs,
+    int res,
+    int rds,
+    int rdi,
+    int rsi,
+    int rbp,
+    int rsp,
+    int rbx,
+    int rdx,
+    int rcx,
+    int rax)
+
+{
+    fixebp();
+    I_MouseEvent(MK_FP(rds, rsi));
+}
+
+static void I_StartupMouseCallback(void)
+{
+    void far *fp;
+
+    // DPMI allocate real mode callback
+    segread(&segregs);
+    regs.w.ax = 0x0303;
+    fp = (void far *)I_MouseCallback;
+    segregs.ds = FP_SEG(fp);
+    regs.x.esi = FP_OFF(fp);
+    fp = (void far *)&mouseregs;
+    segregs.es = FP_SEG(fp);
+    regs.x.edi = FP_OFF(fp);
+    int386x(DPMI_INT, &regs, &regs, &segregs);
+
+    // Keep polling the driver
+    if (regs.x.cflag != 0)
+        return;
+
+    mousecallbackseg = regs.w.cx;
+    mousecallbackoff = regs.w.dx;
+
+    // Start counting from zero
+    SetBytes(&dpmiregs, 0, sizeof(dpmiregs));
+    dpmiregs.eax = 11; // read counters
+    DPMIInt(0x33);
+
+    mousebuttons = 0;
+    mousemickeys = 0;
+    lastmousemickeys = 0;
+
+    SetBytes(&dpmiregs, 0, sizeof(dpmiregs));
+    dpmiregs.eax = 12;   // set event handler
+    dpmiregs.ecx = 0x7F; // movement and all button presses / releases
+    dpmiregs.es = mousecallbackseg;
+    dpmiregs.edx = mousecallbackoff;
+    DPMIInt(0x33);
+
+    mousecallback = 1;
+}
+
 int I_ResetMouse(void)
 {
     regs.w.ax = 0; // reset
@@ -1013,6 +1104,8 @@ void I_StartupMouse(void)
     printf("Mouse: detected\n", 0);
 
     mousepresent = 1;
+
+    I_StartupMouseCallback();
 }
 
 //
@@ -1025,7 +1118,19 @@ void I_ShutdownMouse(void)
         return;
     }
 
+    // Also removes the event handler
     I_ResetMouse();
+
+    if (mousecallback)
+    {
+        // DPMI free real mode callback
+        regs.w.ax = 0x0304;
+        regs.w.cx = mousecallbackseg;
+        regs.w.dx = mousecallbackoff;
+        int386(DPMI_INT, &regs, &regs);
+
+        mousecallback = 0;
+    }
 }
 
 //
@@ -1041,6 +1146,18 @@ void I_ReadMouse(void)
 
     ev.type = ev_mouse;
 
+    if (mousecallback)
+    {
+        short mickeys = mousemickeys;
+
+        ev.data1 = mousebuttons;
+        ev.data2 = (short)(mickeys - lastmousemickeys);
+        lastmousemickeys = mickeys;
+
+        D_PostEvent(&ev);
+        return;
+    }
+
     SetBytes(&dpmiregs, 0, sizeof(dpmiregs));
     dpmiregs.eax = 3; // read buttons / position
     DPMIInt(0x33);
@@ -1287,6 +1404,10 @@ int I_GetCPUModel(void)
 {
     int result;
     union REGS r;
+
+    if (cpuinfo.family != 0)
+        return (cpuinfo.family >= 6 ? 6 : cpuinfo.family) * 100 + 86;
+
     r.x.eax = 0x0400; // DPMI get version
     int386(0x31, &r, &r);
     result = (r.x.ecx & 0xff) * 100 + 86; // Returns: 386,486,586,686
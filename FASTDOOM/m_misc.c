@@ -312,8 +312,12 @@ default_t defaults[] =
         {"debugCardReverse", &debugCardReverse, 0},
         {"busSpeed", &busSpeed, 0},
         {"uncapped", &uncappedFPS, 0},
+        {"autoDetail", &autoDetail, 0},
         {"flatsky", &flatSky, 0},
         {"near", &nearSprites, 0},
+        {"mipmap", &mipmapWalls, 0},
+        {"lodSpan", &lodSpan, 0},
+        {"deferWalls", &deferWalls, 0},
         {"nomelt", &noMelt, 0},
         {"invisibleRender", &invisibleRender, 0},
         {"visplaneRender", &visplaneRender, 0},
@@ -44,6 +44,9 @@ void (*ADBFX_CallBack)(void);
 
 unsigned char *AdlibLUTdb;
 
+// Level currently in the carrier register, repeated samples aren't sent
+static unsigned char ADBFX_LastValue;
+
 static void ADBFX_UpdatePointer()
 {
     ADBFX_SoundPtr++;
@@ -75,7 +78,16 @@ static void ADBFX_ServiceInterrupt_ISA(task *Task)
 {
     unsigned char value = AdlibLUTdb[(unsigned char)(*ADBFX_SoundPtr)];
 
-    outp(ADLIB_PORT + 1, value);
+    if (value != ADBFX_LastValue)
+    {
+        ADBFX_LastValue = value;
+        outp(ADLIB_PORT + 1, value);
+        AL_PortWrites++;
+    }
+    else
+    {
+        AL_SkippedWrites++;
+    }
 
     ADBFX_UpdatePointer();
 }
@@ -87,10 +99,19 @@ static void ADBFX_ServiceInterrupt_OPLxLPT(task *Task)
 
     unsigned char value = AdlibLUTdb[(unsigned char)(*ADBFX_SoundPtr)];
 
-    outp(lpt_data, value);
-    outp(lpt_ctrl, 12);
-    outp(lpt_ctrl, 8);
-    outp(lpt_ctrl, 12);
+    if (value != ADBFX_LastValue)
+    {
+        ADBFX_LastValue = value;
+        outp(lpt_data, value);
+        outp(lpt_ctrl, 12);
+        outp(lpt_ctrl, 8);
+        outp(lpt_ctrl, 12);
+        AL_PortWrites++;
+    }
+    else
+    {
+        AL_SkippedWrites++;
+    }
 
     ADBFX_UpdatePointer();
 }
@@ -205,8 +226,11 @@ int ADBFX_Init(int soundcard, int address)
     AL_SendOutputToPort(ADLIB_PORT, 0xB0, 0x20);
     AL_SendOutputToPort(ADLIB_PORT, 0xA0, 0x00);
 
-    /* First sample */
+    /* First sample. The samples are written without selecting the
+       register again, so this write must reach the chip. */
+    AL_ClearShadow();
     AL_SendOutputToPort(ADLIB_PORT, 0x40, 0x00);
+    ADBFX_LastValue = 0x00;
 
     ADBFX_SoundPlaying = 0;
 
@@ -46,18 +46,6 @@ static struct SREGS SegRegs;
 
 // Intermediary function: DPMI calls this, making it
 // easier to write in C
-// handle 16-bit incoming stack
-
-void fixebp(void);
-
-#pragma aux fixebp = \
-    "mov   bx,  ss"  \
-    "lar   ebx, ebx" \
-    "bt    ebx, 22"  \
-    "jc    bigstk"   \
-    "and   esp, 0x0000FFFF" \
-    "mov   ebp, esp" \
-    "bigstk:" modify exact[ebx];
 
 #pragma aux rmcallback parm[];
 
@@ -13,4 +13,16 @@ enum IRQ_ERRORS
 int IRQ_SetVector(int vector, void(__interrupt *function)(void));
 int IRQ_RestoreVector(int vector);
 
+// For DPMI real mode callbacks, handle 16-bit incoming stack
+void fixebp(void);
+
+#pragma aux fixebp = \
+    "mov   bx,  ss"  \
+    "lar   ebx, ebx" \
+    "bt    ebx, 22"  \
+    "jc    bigstk"   \
+    "and   esp, 0x0000FFFF" \
+    "mov   ebp, esp" \
+    "bigstk:" modify exact[ebx];
+
 #endif
@@ -14,6 +14,7 @@
 #include "options.h"
 #include "fastmath.h"
 #include "z_zone.h"
+#include "i_cpu.h"
 
 extern int MUSIC_SoundDevice;
 
@@ -21,10 +22,20 @@ static const char _MIDI_CommandLengths[NUM_MIDI_CHANNELS] =
     {
         0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 1, 1, 2, 0};
 
+// MIDI controllers for the MUS controller and system event numbers
+static const unsigned char _MUS_Controllers[15] =
+    {
+        0x00, 0x20, 0x01, 0x07, 0x0A, 0x0B, 0x5B, 0x5D,
+        0x40, 0x43, 0x78, 0x7B, 0x7E, 0x7F, 0x79};
+
 static track *_MIDI_TrackPtr = NULL;
 static int _MIDI_TrackMemSize;
 static int _MIDI_NumTracks;
 
+static midievent *_MIDI_Events = NULL;
+static midievent *_MIDI_CurrentEvent;
+static int _MIDI_NumEvents;
+
 static int _MIDI_SongActive = FALSE;
 static int _MIDI_SongLoaded = FALSE;
 static int _MIDI_Loop = FALSE;
@@ -32,24 +43,9 @@ static int _MIDI_Loop = FALSE;
 static task *_MIDI_PlayRoutine = NULL;
 
 static int _MIDI_Division;
-static int _MIDI_Tick = 0;
-static int _MIDI_Beat = 1;
-static int _MIDI_Measure = 1;
-static unsigned _MIDI_Time;
-static int _MIDI_BeatsPerMeasure;
-static int _MIDI_TicksPerBeat;
-static int _MIDI_TimeBase;
-static long _MIDI_FPSecondsPerTick;
-static unsigned _MIDI_TotalTime;
-static int _MIDI_TotalTicks;
-static int _MIDI_TotalBeats;
-static int _MIDI_TotalMeasures;
 
 static unsigned long _MIDI_PositionInTicks;
 
-static int _MIDI_Context;
-
-static int _MIDI_ActiveTracks;
 static int _MIDI_TotalVolume = MIDI_MaxVolume;
 
 static int _MIDI_ChannelVolume[NUM_MIDI_CHANNELS];
@@ -60,6 +56,8 @@ static int Reset = FALSE;
 
 int MIDI_Tempo = 120;
 
+isrprofile_t MIDI_ISRProfile;
+
 char MIDI_PatchMap[128];
 
 /*---------------------------------------------------------------------
@@ -115,7 +113,7 @@ static long _MIDI_ReadDelta(
         {
             GET_NEXT_EVENT(ptr, c);
             value = (value << 7) + (c & 0x7f);
-        } while (c & 0x80);
+        } while ((c & 0x80) && ptr->pos < ptr->end);
     }
 
     return (value);
@@ -134,347 +132,495 @@ static void _MIDI_ResetTracks(
     int i;
     track *ptr;
 
-    _MIDI_Tick = 0;
-    _MIDI_Beat = 1;
-    _MIDI_Measure = 1;
-    _MIDI_Time = 0;
-    _MIDI_BeatsPerMeasure = 4;
-    _MIDI_TicksPerBeat = _MIDI_Division;
-    _MIDI_TimeBase = 4;
-
     _MIDI_PositionInTicks = 0;
-    _MIDI_ActiveTracks = 0;
-    _MIDI_Context = 0;
+    _MIDI_CurrentEvent = _MIDI_Events;
 
     ptr = _MIDI_TrackPtr;
+    if (ptr == NULL)
+    {
+        return;
+    }
+
     for (i = 0; i < _MIDI_NumTracks; i++)
     {
         ptr->pos = ptr->start;
-        ptr->delay = _MIDI_ReadDelta(ptr);
-        ptr->active = TRUE;
+        ptr->time = 0;
         ptr->RunningStatus = 0;
 
-        _MIDI_ActiveTracks += ptr->active != 0;
+        // Empty tracks have no delta time to read
+        if (ptr->pos < ptr->end)
+        {
+            ptr->time = _MIDI_ReadDelta(ptr);
+        }
+        ptr->active = ptr->pos < ptr->end;
 
         ptr++;
     }
 }
 
+void MIDI_SysEx_Ext(unsigned char *data, int length)
+{
+    if (_MIDI_Funcs->SysEx) {
+        _MIDI_Funcs->SysEx(data, length);
+    }
+}
+
 /*---------------------------------------------------------------------
-   Function: _MIDI_AdvanceTick
+   Function: _MIDI_DecodeEvent
 
-   Increment tick counters.
+   Reads the next event of a track. Returns FALSE if the event
+   doesn't have to be sent to the music device.
 ---------------------------------------------------------------------*/
 
-static void _MIDI_AdvanceTick(void)
+static int _MIDI_DecodeEvent(
+    track *Track,
+    midievent *Event)
+
 {
-    int tickDivision;
-    int beatDivision;
+    int event;
+    int command;
+    int length;
 
-    _MIDI_PositionInTicks++;
-    _MIDI_Time += _MIDI_FPSecondsPerTick;
+    GET_NEXT_EVENT(Track, event);
+
+    if (GET_MIDI_COMMAND(event) == MIDI_SPECIAL)
+    {
+        switch (event)
+        {
+        case MIDI_SYSEX:
+            Event->command = MIDI_SYSEX;
+            Event->data.sysex = Track->pos;
+            Track->pos += _MIDI_ReadDelta(Track);
+            return TRUE;
 
-    _MIDI_Tick++;
+        case MIDI_SYSEX_CONTINUE:
+            Track->pos += _MIDI_ReadDelta(Track);
+            break;
 
-    if (_MIDI_TicksPerBeat != 70)
+        case MIDI_META_EVENT:
+            GET_NEXT_EVENT(Track, command);
+            GET_NEXT_EVENT(Track, length);
+
+            Track->pos += length;
+
+            switch (command)
+            {
+            case MIDI_END_OF_TRACK:
+                Track->active = FALSE;
+                break;
+
+            case MIDI_TEMPO_CHANGE:
+                Event->command = MIDI_META_EVENT;
+                Event->data.tempo = 60000000L / _MIDI_ReadNumber(Track->pos - length, 3);
+                return TRUE;
+            }
+            break;
+        }
+
+        return FALSE;
+    }
+
+    if (event & MIDI_RUNNING_STATUS)
     {
-        tickDivision = (_MIDI_Tick / _MIDI_TicksPerBeat) + 1;
-        _MIDI_Tick -= tickDivision * _MIDI_TicksPerBeat;
+        Track->RunningStatus = event;
     }
     else
     {
-        tickDivision = Div70(_MIDI_Tick) + 1;
-        _MIDI_Tick -= Mul70(tickDivision);
+        event = Track->RunningStatus;
+        Track->pos--;
     }
 
-    _MIDI_Beat += tickDivision;
+    Event->channel = GET_MIDI_CHANNEL(event);
+    Event->command = GET_MIDI_COMMAND(event);
 
-    if (_MIDI_BeatsPerMeasure != 4)
+    if (_MIDI_CommandLengths[Event->command] > 0)
     {
-        while (_MIDI_Beat > _MIDI_BeatsPerMeasure)
+        GET_NEXT_EVENT(Track, Event->c1);
+        if (_MIDI_CommandLengths[Event->command] > 1)
         {
-            _MIDI_Beat -= _MIDI_BeatsPerMeasure;
-            _MIDI_Measure++;
+            GET_NEXT_EVENT(Track, Event->c2);
         }
     }
-    else
+
+    if (Event->command == MIDI_CONTROL_CHANGE && Event->c1 == MIDI_MONO_MODE_ON)
     {
-        tickDivision = (_MIDI_Tick >> 2) + 1;
-        _MIDI_Tick -= tickDivision << 2;
-        _MIDI_Beat += tickDivision;
+        Track->pos++;
+        return FALSE;
     }
+
+    return TRUE;
 }
 
 /*---------------------------------------------------------------------
-   Function: _MIDI_SysEx
+   Function: _MIDI_FlattenTracks
 
-   Interpret SysEx Event.
+   Merges all the tracks into a single time sorted event array, so
+   the timer interrupt doesn't have to parse the MIDI data. Events
+   at the same time keep the track order. The last event marks the
+   end of the song.
 ---------------------------------------------------------------------*/
 
-static void _MIDI_SysEx(track *Track)
-{
-    int length;
-
-    length = _MIDI_ReadDelta(Track);
-    if (_MIDI_Funcs->SysEx) {
-        _MIDI_Funcs->SysEx(Track->pos, length);
-    }
-    Track->pos += length;
-}
+static int _MIDI_FlattenTracks(
+    void)
 
-void MIDI_SysEx_Ext(unsigned char *data, int length)
 {
-    if (_MIDI_Funcs->SysEx) {
-        _MIDI_Funcs->SysEx(data, length);
-    }
-}
-
-/*---------------------------------------------------------------------
-   Function: _MIDI_MetaEvent
-
-   Interpret Meta Event.
----------------------------------------------------------------------*/
+    int pass;
+    int tracknum;
+    int count;
+    unsigned long endtick;
+    track *Track;
+    track *Next;
+    midievent event;
+    midievent *Event;
 
-static void _MIDI_MetaEvent(
-    track *Track)
+    // The first pass counts the events, the second stores them
+    for (pass = 0; pass < 2; pass++)
+    {
+        _MIDI_ResetTracks();
 
-{
-    int command;
-    int length;
-    int denominator;
-    long tempo;
+        count = 0;
+        endtick = 0;
+        Event = _MIDI_Events;
 
-    GET_NEXT_EVENT(Track, command);
-    GET_NEXT_EVENT(Track, length);
+        while (1)
+        {
+            Next = NULL;
+            Track = _MIDI_TrackPtr;
+            for (tracknum = 0; tracknum < _MIDI_NumTracks; tracknum++, Track++)
+            {
+                if (Track->active && (Next == NULL || Track->time < Next->time))
+                {
+                    Next = Track;
+                }
+            }
 
-    switch (command)
-    {
-    case MIDI_END_OF_TRACK:
-        Track->active = FALSE;
+            if (Next == NULL)
+            {
+                break;
+            }
 
-        _MIDI_ActiveTracks--;
-        break;
+            if (_MIDI_DecodeEvent(Next, &event))
+            {
+                if (pass)
+                {
+                    event.tick = Next->time;
+                    *Event++ = event;
+                }
+                count++;
+            }
 
-    case MIDI_TEMPO_CHANGE:
-        // VITI95: OPTIMIZE
-        tempo = 60000000L / _MIDI_ReadNumber(Track->pos, 3);
-        MIDI_SetTempo(tempo);
-        break;
+            if (Next->active && Next->pos < Next->end)
+            {
+                Next->time += _MIDI_ReadDelta(Next);
+            }
+            else
+            {
+                Next->active = FALSE;
+                endtick = max(endtick, Next->time);
+            }
+        }
 
-    case MIDI_TIME_SIGNATURE:
-        if ((_MIDI_Tick > 0) || (_MIDI_Beat > 1))
+        if (pass)
         {
-            _MIDI_Measure++;
+            Event->tick = endtick;
+            Event->command = MIDI_END_OF_TRACK;
         }
-
-        _MIDI_Tick = 0;
-        _MIDI_Beat = 1;
-
-        _MIDI_BeatsPerMeasure = (int)*Track->pos;
-        denominator = (int)*(Track->pos + 1);
-        _MIDI_TimeBase = 1;
-        while (denominator > 0)
+        else
         {
-            _MIDI_TimeBase += _MIDI_TimeBase;
-            denominator--;
+            _MIDI_NumEvents = count + 1;
+            _MIDI_Events = Z_MallocUnowned(_MIDI_NumEvents * sizeof(midievent), PU_STATIC);
         }
-        // VITI95: OPTIMIZE
-        _MIDI_TicksPerBeat = (_MIDI_Division * 4) / _MIDI_TimeBase;
-        break;
     }
 
-    Track->pos += length;
+    return (MIDI_Ok);
 }
 
 /*---------------------------------------------------------------------
-   Function: _MIDI_InterpretControllerInfo
+   Function: _MIDI_AddEvent
 
-   Interprets the MIDI controller info.
+   Stores an event of a MUS score. Only counts it if there is no
+   event array yet.
 ---------------------------------------------------------------------*/
 
-static int _MIDI_InterpretControllerInfo(
-    track *Track,
-    int TimeSet,
+static void _MIDI_AddEvent(
+    midievent **Event,
+    int *count,
+    unsigned long tick,
+    int command,
     int channel,
     int c1,
     int c2)
 
 {
-    track *trackptr;
-    int tracknum;
-    int loopcount;
-
-    switch (c1)
+    if (*Event != NULL)
     {
-    case MIDI_MONO_MODE_ON:
-        Track->pos++;
-        break;
-
-    case MIDI_VOLUME:
-        _MIDI_SetChannelVolume(channel, c2);
-        break;
-
-    default:
-        _MIDI_Funcs->ControlChange(channel, c1, c2);
+        (*Event)->tick = tick;
+        (*Event)->command = command;
+        (*Event)->channel = channel;
+        (*Event)->c1 = c1;
+        (*Event)->c2 = c2;
+        (*Event)++;
     }
 
-    return TimeSet;
+    (*count)++;
 }
 
 /*---------------------------------------------------------------------
-   Function: _MIDI_ServiceRoutine
+   Function: _MIDI_FlattenMUS
 
-   Task that interperates the MIDI data.
+   Decodes a MUS score straight into the event array, the same way
+   mus2mid would have converted it to a MIDI file.
 ---------------------------------------------------------------------*/
-// NOTE: We have to use a stack frame here because of a strange bug
-// that occurs with Watcom.  This means that we cannot access Task!
-//Turned off to test if it works with Watcom 10a
-//#pragma aux _MIDI_ServiceRoutine frame;
-/*
-static void test
-   (
-   task *Task
-   )
-   {
-   _MIDI_ServiceRoutine( Task );
-   _MIDI_ServiceRoutine( Task );
-   _MIDI_ServiceRoutine( Task );
-   _MIDI_ServiceRoutine( Task );
-   }
-*/
-static void _MIDI_ServiceRoutine(task *Task)
+
+static int _MIDI_FlattenMUS(
+    unsigned char *score,
+    unsigned char *end)
+
 {
-    int event;
+    int pass;
+    int count;
+    int descriptor;
+    int muschannel;
     int channel;
-    int command;
-    track *Track;
-    int tracknum;
-    int status;
+    int nextchannel;
     int c1;
     int c2;
-    int TimeSet;
+    int scoreend;
+    unsigned long tick;
+    unsigned long delay;
+    unsigned char *ptr;
+    midievent *Event;
+    signed char channelmap[NUM_MIDI_CHANNELS];
+    unsigned char velocity[NUM_MIDI_CHANNELS];
 
-    if (!_MIDI_SongActive)
+    // The first pass counts the events, the second stores them
+    for (pass = 0; pass < 2; pass++)
     {
-        return;
-    }
+        ptr = score;
+        tick = 0;
+        count = 0;
+        Event = pass ? _MIDI_Events : NULL;
 
-    TimeSet = FALSE;
-    Track = _MIDI_TrackPtr;
-    tracknum = 0;
-    while (tracknum < _MIDI_NumTracks)
-    {
-        while ((Track->active) && (Track->delay == 0))
+        memset(channelmap, -1, sizeof(channelmap));
+        memset(velocity, 127, sizeof(velocity));
+        nextchannel = 0;
+        scoreend = FALSE;
+
+        while (!scoreend && ptr < end)
         {
-            GET_NEXT_EVENT(Track, event);
+            descriptor = *ptr++;
+            muschannel = descriptor & 0x0f;
 
-            if (GET_MIDI_COMMAND(event) == MIDI_SPECIAL)
+            if (muschannel == MUS_PERCUSSION_CHANNEL)
             {
-                switch (event)
+                channel = MIDI_RHYTHM_CHANNEL;
+            }
+            else
+            {
+                if (channelmap[muschannel] < 0)
                 {
-                case MIDI_SYSEX:
-                    _MIDI_SysEx(Track);
-                    break;
-                case MIDI_SYSEX_CONTINUE:
-                    Track->pos += _MIDI_ReadDelta(Track);
-                    break;
-                case MIDI_META_EVENT:
-                    _MIDI_MetaEvent(Track);
-                    break;
-                }
+                    // MIDI channels are handed out in order of use. Silence
+                    // whatever the previous song left playing on them.
+                    if (nextchannel == MIDI_RHYTHM_CHANNEL)
+                    {
+                        nextchannel++;
+                    }
 
-                if (Track->active)
-                {
-                    Track->delay = _MIDI_ReadDelta(Track);
+                    channelmap[muschannel] = nextchannel++;
+                    _MIDI_AddEvent(&Event, &count, tick, MIDI_CONTROL_CHANGE,
+                                   channelmap[muschannel], MIDI_ALL_NOTES_OFF, 0);
                 }
 
-                continue;
+                channel = channelmap[muschannel];
             }
 
-            if (event & MIDI_RUNNING_STATUS)
-            {
-                Track->RunningStatus = event;
-            }
-            else
+            switch ((descriptor >> 4) & 7)
             {
-                event = Track->RunningStatus;
-                Track->pos--;
-            }
-
-            channel = GET_MIDI_CHANNEL(event);
-            command = GET_MIDI_COMMAND(event);
+            case MUS_RELEASE_NOTE:
+                c1 = *ptr++;
+                _MIDI_AddEvent(&Event, &count, tick, MIDI_NOTE_OFF, channel, c1 & 0x7f, 0);
+                break;
 
-            if (_MIDI_CommandLengths[command] > 0)
-            {
-                GET_NEXT_EVENT(Track, c1);
-                if (_MIDI_CommandLengths[command] > 1)
+            case MUS_PLAY_NOTE:
+                c1 = *ptr++;
+                if (c1 & 0x80)
                 {
-                    GET_NEXT_EVENT(Track, c2);
+                    velocity[muschannel] = *ptr++ & 0x7f;
                 }
-            }
-
-            switch (command)
-            {
-            case MIDI_NOTE_OFF:
-                _MIDI_Funcs->NoteOff(channel, c1, c2);
+                _MIDI_AddEvent(&Event, &count, tick, MIDI_NOTE_ON, channel, c1 & 0x7f, velocity[muschannel]);
                 break;
 
-            case MIDI_NOTE_ON:
-                _MIDI_Funcs->NoteOn(channel, c1, c2);
+            case MUS_PITCH_BEND:
+                // 8 bit bend to 14 bit
+                c1 = *ptr++ << 6;
+                _MIDI_AddEvent(&Event, &count, tick, MIDI_PITCH_BEND, channel, c1 & 0x7f, c1 >> 7);
                 break;
 
-            case MIDI_POLY_AFTER_TCH:
-                if (_MIDI_Funcs->PolyAftertouch)
+            case MUS_SYSTEM_EVENT:
+                c1 = *ptr++;
+                if (c1 >= 10 && c1 <= 14 && _MUS_Controllers[c1] != MIDI_MONO_MODE_ON)
                 {
-                    _MIDI_Funcs->PolyAftertouch(channel, c1, c2);
+                    _MIDI_AddEvent(&Event, &count, tick, MIDI_CONTROL_CHANGE, channel, _MUS_Controllers[c1], 0);
                 }
                 break;
 
-            case MIDI_CONTROL_CHANGE:
-                TimeSet = _MIDI_InterpretControllerInfo(Track, TimeSet,
-                                                        channel, c1, c2);
-                break;
-
-            case MIDI_PROGRAM_CHANGE:
-                    _MIDI_Funcs->ProgramChange(channel, MIDI_PatchMap[c1 & 0x7f]);
-                break;
+            case MUS_CONTROLLER:
+                c1 = *ptr++;
+                c2 = *ptr++;
 
-            case MIDI_AFTER_TOUCH:
-                if (_MIDI_Funcs->ChannelAftertouch)
+                if (c1 == 0)
                 {
-                    _MIDI_Funcs->ChannelAftertouch(channel, c1);
+                    // Program numbers are masked, controller values clamped, like mus2mid did
+                    _MIDI_AddEvent(&Event, &count, tick, MIDI_PROGRAM_CHANGE, channel, c2 & 0x7f, 0);
+                }
+                else if (c1 <= 9)
+                {
+                    if (c2 > 0x7f)
+                    {
+                        c2 = 0x7f;
+                    }
+
+                    _MIDI_AddEvent(&Event, &count, tick, MIDI_CONTROL_CHANGE, channel, _MUS_Controllers[c1], c2);
                 }
                 break;
 
-            case MIDI_PITCH_BEND:
-                _MIDI_Funcs->PitchBend(channel, c1, c2);
+            case MUS_SCORE_END:
+            default:
+                scoreend = TRUE;
                 break;
             }
 
-            Track->delay = _MIDI_ReadDelta(Track);
+            // The last event of a group is followed by the delay
+            if ((descriptor & 0x80) && !scoreend)
+            {
+                delay = 0;
+                do
+                {
+                    c1 = *ptr++;
+                    delay = (delay << 7) + (c1 & 0x7f);
+                } while (c1 & 0x80);
+
+                tick += delay;
+            }
+        }
+
+        if (pass)
+        {
+            Event->tick = tick;
+            Event->command = MIDI_END_OF_TRACK;
+        }
+        else
+        {
+            _MIDI_NumEvents = count + 1;
+            _MIDI_Events = Z_MallocUnowned(_MIDI_NumEvents * sizeof(midievent), PU_STATIC);
         }
+    }
+
+    return (MIDI_Ok);
+}
+
+/*---------------------------------------------------------------------
+   Function: _MIDI_ServiceRoutine
+
+   Task that sends the MIDI events to the music device.
+---------------------------------------------------------------------*/
+
+static void _MIDI_ServiceRoutine(task *Task)
+{
+    midievent *Event;
+    unsigned int start;
+
+    if (!_MIDI_SongActive)
+    {
+        return;
+    }
 
-        Track->delay--;
-        Track++;
-        tracknum++;
+    start = I_StartProfileISR();
 
-        if (_MIDI_ActiveTracks == 0)
+    Event = _MIDI_CurrentEvent;
+    while (Event->tick <= _MIDI_PositionInTicks)
+    {
+        switch (Event->command)
         {
-            _MIDI_ResetTracks();
-            if (_MIDI_Loop)
+        case MIDI_NOTE_OFF:
+            _MIDI_Funcs->NoteOff(Event->channel, Event->c1, Event->c2);
+            break;
+
+        case MIDI_NOTE_ON:
+            _MIDI_Funcs->NoteOn(Event->channel, Event->c1, Event->c2);
+            break;
+
+        case MIDI_POLY_AFTER_TCH:
+            if (_MIDI_Funcs->PolyAftertouch)
             {
-                tracknum = 0;
-                Track = _MIDI_TrackPtr;
+                _MIDI_Funcs->PolyAftertouch(Event->channel, Event->c1, Event->c2);
+            }
+            break;
+
+        case MIDI_CONTROL_CHANGE:
+            if (Event->c1 == MIDI_VOLUME)
+            {
+                _MIDI_SetChannelVolume(Event->channel, Event->c2);
             }
             else
             {
-                _MIDI_SongActive = FALSE;
-                break;
+                _MIDI_Funcs->ControlChange(Event->channel, Event->c1, Event->c2);
+            }
+            break;
+
+        case MIDI_PROGRAM_CHANGE:
+            _MIDI_Funcs->ProgramChange(Event->channel, MIDI_PatchMap[Event->c1 & 0x7f]);
+            break;
+
+        case MIDI_AFTER_TOUCH:
+            if (_MIDI_Funcs->ChannelAftertouch)
+            {
+                _MIDI_Funcs->ChannelAftertouch(Event->channel, Event->c1);
+            }
+            break;
+
+        case MIDI_PITCH_BEND:
+            _MIDI_Funcs->PitchBend(Event->channel, Event->c1, Event->c2);
+            break;
+
+        case MIDI_SYSEX:
+            if (_MIDI_Funcs->SysEx)
+            {
+                track sysex;
+                int length;
+
+                sysex.pos = Event->data.sysex;
+                length = _MIDI_ReadDelta(&sysex);
+                _MIDI_Funcs->SysEx(sysex.pos, length);
+            }
+            break;
+
+        case MIDI_META_EVENT:
+            MIDI_SetTempo(Event->data.tempo);
+            break;
+
+        case MIDI_END_OF_TRACK:
+            _MIDI_ResetTracks();
+
+            // Restart within the same tick, like the song never stopped
+            if (_MIDI_Loop && Event->tick > 0)
+            {
+                Event = _MIDI_Events;
+                continue;
             }
+
+            _MIDI_SongActive = FALSE;
+            I_EndProfileISR(&MIDI_ISRProfile, start);
+            return;
         }
+
+        Event++;
     }
 
-    _MIDI_AdvanceTick();
+    _MIDI_CurrentEvent = Event;
+    _MIDI_PositionInTicks++;
+
+    I_EndProfileISR(&MIDI_ISRProfile, start);
 }
 
 /*---------------------------------------------------------------------
@@ -709,28 +855,43 @@ void MIDI_StopSong(
         MIDI_Reset();
         _MIDI_ResetTracks();
 
-        Z_Free(_MIDI_TrackPtr);
-
-        _MIDI_TrackPtr = NULL;
-        _MIDI_NumTracks = 0;
-        _MIDI_TrackMemSize = 0;
+        Z_Free(_MIDI_Events);
 
-        _MIDI_TotalTime = 0;
-        _MIDI_TotalTicks = 0;
-        _MIDI_TotalBeats = 0;
-        _MIDI_TotalMeasures = 0;
+        _MIDI_Events = NULL;
+        _MIDI_CurrentEvent = NULL;
+        _MIDI_NumEvents = 0;
     }
 }
 
 /*---------------------------------------------------------------------
-   Function: MIDI_PlaySong
+   Function: _MIDI_LoadMUS
 
-   Begins playback of a MIDI song.
+   Builds the event array of a MUS song.
 ---------------------------------------------------------------------*/
 
-int MIDI_PlaySong(
-    unsigned char *song,
-    int loopflag)
+static int _MIDI_LoadMUS(
+    unsigned char *song)
+
+{
+    unsigned short scorelength;
+    unsigned short scorestart;
+
+    scorelength = ((unsigned short *)song)[2];
+    scorestart = ((unsigned short *)song)[3];
+
+    _MIDI_Division = MUS_DIVISION;
+
+    return (_MIDI_FlattenMUS(song + scorestart, song + scorestart + scorelength));
+}
+
+/*---------------------------------------------------------------------
+   Function: _MIDI_LoadMIDI
+
+   Builds the event array of a MIDI song.
+---------------------------------------------------------------------*/
+
+static int _MIDI_LoadMIDI(
+    unsigned char *song)
 
 {
     int numtracks;
@@ -740,23 +901,6 @@ int MIDI_PlaySong(
     track *CurrentTrack;
     unsigned char *ptr;
 
-    if (_MIDI_SongLoaded)
-    {
-        MIDI_StopSong();
-    }
-
-    _MIDI_Loop = loopflag;
-
-    if (_MIDI_Funcs == NULL)
-    {
-        return (MIDI_NullMidiModule);
-    }
-
-    if (*(unsigned long *)song != MIDI_HEADER_SIGNATURE)
-    {
-        return (MIDI_InvalidMidiFile);
-    }
-
     song += 4;
 
     headersize = _MIDI_ReadNumber(song, 4);
@@ -803,16 +947,71 @@ int MIDI_PlaySong(
         ptr += 8;
         CurrentTrack->start = ptr;
         ptr += tracklength;
+        CurrentTrack->end = ptr;
         CurrentTrack++;
     }
 
+    _MIDI_FlattenTracks();
+
+    // Only the event array is needed from now on
+    Z_Free(_MIDI_TrackPtr);
+
+    _MIDI_TrackPtr = NULL;
+    _MIDI_NumTracks = 0;
+    _MIDI_TrackMemSize = 0;
+
+    return (MIDI_Ok);
+}
+
+/*---------------------------------------------------------------------
+   Function: MIDI_PlaySong
+
+   Begins playback of a MIDI or MUS song.
+---------------------------------------------------------------------*/
+
+int MIDI_PlaySong(
+    unsigned char *song,
+    int loopflag)
+
+{
+    int status;
+
+    if (_MIDI_SongLoaded)
+    {
+        MIDI_StopSong();
+    }
+
+    _MIDI_Loop = loopflag;
+
+    if (_MIDI_Funcs == NULL)
+    {
+        return (MIDI_NullMidiModule);
+    }
+
+    switch (*(unsigned long *)song)
+    {
+    case MUS_HEADER_SIGNATURE:
+        status = _MIDI_LoadMUS(song);
+        break;
+
+    case MIDI_HEADER_SIGNATURE:
+        status = _MIDI_LoadMIDI(song);
+        break;
+
+    default:
+        return (MIDI_InvalidMidiFile);
+    }
+
+    if (status != MIDI_Ok)
+    {
+        return (status);
+    }
+
     if (_MIDI_Funcs->GetVolume != NULL)
     {
         _MIDI_TotalVolume = _MIDI_Funcs->GetVolume();
     }
 
-    _MIDI_InitEMIDI();
-
     _MIDI_ResetTracks();
 
     if (!Reset)
@@ -851,8 +1050,6 @@ void MIDI_SetTempo(int tempo)
         TS_SetTaskRate(_MIDI_PlayRoutine, tickspersecond);
         //      TS_SetTaskRate( _MIDI_PlayRoutine, tickspersecond / 4 );
     }
-    // VITI95: OPTIMIZE
-    _MIDI_FPSecondsPerTick = (1 << TIME_PRECISION) / tickspersecond;
 }
 
 /*---------------------------------------------------------------------
@@ -865,137 +1062,3 @@ int MIDI_SongPlaying(void)
 {
    return _MIDI_SongActive;
 }
-
-/*---------------------------------------------------------------------
-   Function: MIDI_InitEMIDI
-
-   Sets up the EMIDI
----------------------------------------------------------------------*/
-
-static void _MIDI_InitEMIDI(
-    void)
-
-{
-    int event;
-    int command;
-    int channel;
-    int length;
-    int IncludeFound;
-    track *Track;
-    int tracknum;
-    int c1;
-    int c2;
-
-    _MIDI_ResetTracks();
-
-    _MIDI_TotalTime = 0;
-    _MIDI_TotalTicks = 0;
-    _MIDI_TotalBeats = 0;
-    _MIDI_TotalMeasures = 0;
-
-    Track = _MIDI_TrackPtr;
-    tracknum = 0;
-    while ((tracknum < _MIDI_NumTracks) && (Track != NULL))
-    {
-        _MIDI_Tick = 0;
-        _MIDI_Beat = 1;
-        _MIDI_Measure = 1;
-        _MIDI_Time = 0;
-        _MIDI_BeatsPerMeasure = 4;
-        _MIDI_TicksPerBeat = _MIDI_Division;
-        _MIDI_TimeBase = 4;
-
-        _MIDI_PositionInTicks = 0;
-        _MIDI_ActiveTracks = 0;
-        _MIDI_Context = -1;
-
-        Track->RunningStatus = 0;
-        Track->active = TRUE;
-
-        while (Track->delay > 0)
-        {
-            _MIDI_AdvanceTick();
-            Track->delay--;
-        }
-
-        IncludeFound = FALSE;
-        while (Track->active)
-        {
-            GET_NEXT_EVENT(Track, event);
-
-            if (GET_MIDI_COMMAND(event) == MIDI_SPECIAL)
-            {
-                switch (event)
-                {
-                case MIDI_SYSEX:
-                    _MIDI_SysEx(Track);
-                    break;
-                case MIDI_SYSEX_CONTINUE:
-                    Track->pos += _MIDI_ReadDelta(Track);
-                    break;
-                case MIDI_META_EVENT:
-                    _MIDI_MetaEvent(Track);
-                    break;
-                }
-
-                if (Track->active)
-                {
-                    Track->delay = _MIDI_ReadDelta(Track);
-                    while (Track->delay > 0)
-                    {
-                        _MIDI_AdvanceTick();
-                        Track->delay--;
-                    }
-                }
-
-                continue;
-            }
-
-            if (event & MIDI_RUNNING_STATUS)
-            {
-                Track->RunningStatus = event;
-            }
-            else
-            {
-                event = Track->RunningStatus;
-                Track->pos--;
-            }
-
-            channel = GET_MIDI_CHANNEL(event);
-            command = GET_MIDI_COMMAND(event);
-            length = _MIDI_CommandLengths[command];
-
-            if (command == MIDI_CONTROL_CHANGE)
-            {
-                length += *Track->pos == MIDI_MONO_MODE_ON;
-                GET_NEXT_EVENT(Track, c1);
-                GET_NEXT_EVENT(Track, c2);
-                length -= 2;
-            }
-
-            Track->pos += length;
-            Track->delay = _MIDI_ReadDelta(Track);
-
-            while (Track->delay > 0)
-            {
-                _MIDI_AdvanceTick();
-                Track->delay--;
-            }
-        }
-
-        _MIDI_TotalTime = max(_MIDI_TotalTime, _MIDI_Time);
-        if (RELATIVE_BEAT(_MIDI_Measure, _MIDI_Beat, _MIDI_Tick) >
-            RELATIVE_BEAT(_MIDI_TotalMeasures, _MIDI_TotalBeats,
-                          _MIDI_TotalTicks))
-        {
-            _MIDI_TotalTicks = _MIDI_Tick;
-            _MIDI_TotalBeats = _MIDI_Beat;
-            _MIDI_TotalMeasures = _MIDI_Measure;
-        }
-
-        Track++;
-        tracknum++;
-    }
-
-    _MIDI_ResetTracks();
-}
@@ -1,6 +1,8 @@
 #ifndef __MIDI_H
 #define __MIDI_H
 
+#include "i_cpu.h"
+
 enum MIDI_Errors
 {
     MIDI_Warning = -2,
@@ -22,6 +24,9 @@ enum MIDI_Errors
 
 extern char MIDI_PatchMap[128];
 
+// Time spent in the MIDI service routine, part of the timer interrupt
+extern isrprofile_t MIDI_ISRProfile;
+
 typedef struct
 {
     void (*NoteOff)(int channel, int key, int velocity);
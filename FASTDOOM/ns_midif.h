@@ -1,9 +1,6 @@
 #ifndef ___MIDI_H
 #define ___MIDI_H
 
-#define RELATIVE_BEAT(measure, beat, tick) \
-    ((tick) + ((beat) << 9) + ((measure) << 16))
-
 //Bobby Prince thinks this may be 100
 //#define GENMIDI_DefaultVolume 100
 #define GENMIDI_DefaultVolume 90
@@ -12,10 +9,20 @@
 
 #define NUM_MIDI_CHANNELS 16
 
-#define TIME_PRECISION 16
-
 #define MIDI_HEADER_SIGNATURE 0x6468544d // "MThd"
 #define MIDI_TRACK_SIGNATURE 0x6b72544d  // "MTrk"
+#define MUS_HEADER_SIGNATURE 0x1a53554d  // "MUS\x1a"
+
+// MUS scores run at 140 ticks per second
+#define MUS_DIVISION 70
+#define MUS_PERCUSSION_CHANNEL 15
+
+#define MUS_RELEASE_NOTE 0
+#define MUS_PLAY_NOTE 1
+#define MUS_PITCH_BEND 2
+#define MUS_SYSTEM_EVENT 3
+#define MUS_CONTROLLER 4
+#define MUS_SCORE_END 6
 
 #define MIDI_VOLUME 7
 #define MIDI_PAN 10
@@ -57,26 +64,43 @@
 typedef struct
 {
     unsigned char *start;
+    unsigned char *end;
     unsigned char *pos;
 
-    long delay;
+    unsigned long time;
     char active;
     short RunningStatus;
 } track;
 
+// Pre-decoded event. All the tracks of a song are merged into a
+// single array of these, sorted by time.
+typedef struct
+{
+    unsigned long tick;    // Absolute time in MIDI ticks
+    unsigned char command; // Channel command, MIDI_SYSEX, MIDI_META_EVENT
+                           // (tempo change) or MIDI_END_OF_TRACK (song end)
+    unsigned char channel;
+    unsigned char c1;
+    unsigned char c2;
+    union
+    {
+        long tempo;           // Beats per minute
+        unsigned char *sysex; // Length followed by the data
+    } data;
+} midievent;
+
 static long _MIDI_ReadNumber(void *from, size_t size);
 static long _MIDI_ReadDelta(track *ptr);
 static void _MIDI_ResetTracks(void);
-static void _MIDI_AdvanceTick(void);
-static void _MIDI_MetaEvent(track *Track);
-static void _MIDI_SysEx(track *Track);
-static int _MIDI_InterpretControllerInfo(track *Track, int TimeSet,
-                                         int channel, int c1, int c2);
-//static
+static int _MIDI_DecodeEvent(track *Track, midievent *Event);
+static int _MIDI_FlattenTracks(void);
+static void _MIDI_AddEvent(midievent **Event, int *count, unsigned long tick, int command, int channel, int c1, int c2);
+static int _MIDI_FlattenMUS(unsigned char *score, unsigned char *end);
+static int _MIDI_LoadMUS(unsigned char *song);
+static int _MIDI_LoadMIDI(unsigned char *song);
 static void _MIDI_ServiceRoutine(task *Task);
 static int _MIDI_SendControlChange(int channel, int c1, int c2);
 static void _MIDI_SetChannelVolume(int channel, int volume);
 static void _MIDI_SendChannelVolumes(void);
-static void _MIDI_InitEMIDI(void);
 
 #endif
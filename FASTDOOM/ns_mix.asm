@@ -362,3 +362,644 @@ exit8U:
 	pop	ecx
 	pop	ebx
         ret
+
+;================
+;
+; MV_Mix8BitMono1x
+;
+;================
+
+; Same as MV_Mix8BitMono for sounds that play at the mix rate,
+; the source pointer just moves one byte per sample.
+
+; eax - position
+; edx - rate
+; ebx - start
+; ecx - number of samples to mix
+
+CODE_SYM_DEF MV_Mix8BitMono1x
+        push	ebx
+	push	ecx
+	push	edx
+	push	esi
+	push	edi
+	push	ebp
+
+        mov     ebp, eax
+
+        mov     esi, ebx ; Source pointer
+        shr     eax, 16
+        add     esi, eax
+
+        ; Volume table ptr
+        mov     ebx,[_MV_LeftVolume] ; Since we're mono, use left volume
+        mov     eax,dpatch1+4
+        mov     [eax],ebx
+        mov     eax,dpatch2+4
+        mov     [eax],ebx
+
+        ; Harsh Clip table ptr
+        mov     ebx,[_MV_HarshClipTable]
+        mov     eax,dpatch3+3
+        mov     [eax],ebx
+        mov     eax,dpatch4+3
+        mov     [eax],ebx
+
+        mov     edi,[_MV_MixDestination] ; Get the position to write to
+
+        ; Number of samples to mix
+        shr     ecx, 1 ; double sample count
+        test    ecx, ecx
+        je      short exit8M1x
+
+        ; Final position, MV_Mix8BitMono reads two samples ahead
+        ; so its position ends up two samples further
+        lea     eax, [ecx+1]
+        shl     eax, 17
+        add     ebp, eax
+
+;     eax - scratch
+;     ebx - scratch
+;     edx - scratch
+;     ecx - count
+;     edi - destination
+;     esi - source
+;     ebp - final position
+; dpatch1 - volume table
+; dpatch2 - volume table
+; dpatch3 - harsh clip table
+; dpatch4 - harsh clip table
+
+        xor     edx, edx
+
+        align 4
+mix8M1xloop:
+        movzx   eax, byte [esi]                 ; get first sample
+        movzx   ebx, byte [esi+1]               ; get second sample
+        mov     dl, byte [edi]                  ; get current sample from destination
+dpatch1:
+        movsx   eax, byte [2*eax+0x12345678]    ; volume translate first sample
+dpatch2:
+        movsx   ebx, byte [2*ebx+0x12345678]    ; volume translate second sample
+dpatch3:
+        mov     eax, [eax + edx + 0x12345678]   ; mix first sample + harsh clip new sample
+        mov     dl, byte [edi + 1]              ; get current sample from destination
+        mov     [edi], al                       ; write new sample to destination
+dpatch4:
+        mov     ebx, [ebx + edx + 0x12345678]   ; mix second sample + harsh clip new sample
+        add     esi, 2                          ; move source to third sample
+        mov     [edi + 1], bl                   ; write new sample to destination
+        add     edi, 2                          ; move destination to third sample
+        dec     ecx                             ; decrement count
+        jnz     short mix8M1xloop               ; loop
+
+        mov     [_MV_MixDestination], edi       ; Store the current write position
+        mov     [_MV_MixPosition], ebp          ; return position
+exit8M1x:
+        pop	ebp
+	pop	edi
+	pop	esi
+	pop	edx
+	pop	ecx
+	pop	ebx
+        ret
+
+;================
+;
+; MV_Mix8BitStereo1x
+;
+;================
+
+; Same as MV_Mix8BitStereo for sounds that play at the mix rate
+
+; eax - position
+; edx - rate
+; ebx - start
+; ecx - number of samples to mix
+
+CODE_SYM_DEF MV_Mix8BitStereo1x
+        push	ebx
+	push	ecx
+	push	edx
+	push	esi
+	push	edi
+	push	ebp
+
+        mov     ebp, eax
+
+        mov     esi, ebx ; Source pointer
+        shr     eax, 16
+        add     esi, eax
+
+        ; Right channel offset
+        mov     ebx, [_MV_RightChannelOffset]
+        mov     eax, epatch6+2
+        mov     [eax],ebx
+        mov     eax, epatch7+2
+        mov     [eax],ebx
+
+        ; Volume table ptr
+        mov     ebx, [_MV_LeftVolume]
+        mov     eax, epatch1+4
+        mov     [eax],ebx
+
+        mov     ebx, [_MV_RightVolume]
+        mov     eax, epatch2+4
+        mov     [eax],ebx
+
+        ; Harsh Clip table ptr
+        mov     ebx, [_MV_HarshClipTable]
+        mov     eax, epatch4+2
+        mov     [eax],ebx
+        mov     eax, epatch5+2
+        mov     [eax],ebx
+
+        mov     edi, [_MV_MixDestination] ; Get the position to write to
+
+        ; Number of samples to mix
+        test    ecx, ecx
+        je      short exit8S1x
+
+        ; Final position
+        mov     eax, ecx
+        shl     eax, 16
+        add     ebp, eax
+
+;     eax - scratch
+;     ebx - scratch
+;     edx - scratch
+;     ecx - count
+;     edi - destination
+;     esi - source
+;     ebp - final position
+; epatch1 - left volume table
+; epatch2 - right volume table
+; epatch4 - harsh clip table
+; epatch5 - harsh clip table
+; epatch6 - right channel offset
+; epatch7 - right channel offset
+
+        xor     ebx, ebx
+        xor     edx, edx
+
+        align 4
+mix8S1xloop:
+        mov     bl, byte [esi]              ; get sample
+        mov     dl, byte [edi]              ; get current sample from destination
+epatch1:
+        movsx   eax, byte [2*ebx+0x12345678] ; volume translate left sample
+epatch2:
+        movsx   ebx, byte [2*ebx+0x12345678] ; volume translate right sample
+        add     eax, edx                     ; mix left sample
+epatch6:
+        mov     dl, byte [edi+0x12345678]   ; get current sample from destination
+epatch4:
+        mov     eax, [eax + 0x12345678]      ; harsh clip left sample
+        add     ebx, edx                     ; mix right sample
+        mov     [edi], al                    ; write left sample to destination
+epatch5:
+        mov     ebx, [ebx + 0x12345678]      ; harsh clip right sample
+        inc     esi                          ; move source to next sample
+epatch7:
+        mov     [edi+0x12345678], bl         ; write right sample to destination
+        add     edi, 2                       ; move destination to next sample
+        xor     ebx, ebx
+        dec     ecx                          ; decrement count
+        jnz     short mix8S1xloop            ; loop
+
+        mov     [_MV_MixDestination], edi    ; Store the current write position
+        mov     [_MV_MixPosition], ebp       ; return position
+
+exit8S1x:
+        pop	ebp
+	pop	edi
+	pop	esi
+	pop	edx
+	pop	ecx
+	pop	ebx
+        ret
+
+;================
+;
+; MV_Mix8BitUltrasound1x
+;
+;================
+
+; Same as MV_Mix8BitUltrasound for sounds that play at the mix rate
+
+; eax - position
+; edx - rate
+; ebx - start
+; ecx - number of samples to mix
+
+CODE_SYM_DEF MV_Mix8BitUltrasound1x
+        push	ebx
+	push	ecx
+	push	edx
+	push	esi
+	push	edi
+	push	ebp
+
+        mov     ebp, eax
+
+        mov     esi, ebx ; Source pointer
+        shr     eax, 16
+        add     esi, eax
+
+        ; Right channel offset
+        mov     ebx, [_MV_RightChannelOffset]
+        mov     eax, fpatch6+2
+        mov     [eax],ebx
+        mov     eax, fpatch7+2
+        mov     [eax],ebx
+
+        ; Volume table ptr
+        mov     ebx, [_MV_LeftVolume]
+        mov     eax, fpatch1+4
+        mov     [eax],ebx
+
+        mov     ebx, [_MV_RightVolume]
+        mov     eax, fpatch2+4
+        mov     [eax],ebx
+
+        ; Harsh Clip table ptr
+        mov     ebx, [_MV_HarshClipTable]
+        mov     eax, fpatch4+2
+        mov     [eax],ebx
+        mov     eax, fpatch5+2
+        mov     [eax],ebx
+
+        mov     edi, [_MV_MixDestination] ; Get the position to write to
+
+        ; Number of samples to mix
+        test    ecx, ecx
+        je      short exit8U1x
+
+        ; Final position
+        mov     eax, ecx
+        shl     eax, 16
+        add     ebp, eax
+
+;     eax - scratch
+;     ebx - scratch
+;     edx - scratch
+;     ecx - count
+;     edi - destination
+;     esi - source
+;     ebp - final position
+; fpatch1 - left volume table
+; fpatch2 - right volume table
+; fpatch4 - harsh clip table
+; fpatch5 - harsh clip table
+; fpatch6 - right channel offset
+; fpatch7 - right channel offset
+
+        xor     ebx, ebx
+        xor     edx, edx
+
+        align 4
+mix8U1xloop:
+        mov     bl, byte [esi]              ; get sample
+        mov     dl, byte [edi]              ; get current sample from destination
+fpatch1:
+        movsx   eax, byte [2*ebx+0x12345678] ; volume translate left sample
+fpatch2:
+        movsx   ebx, byte [2*ebx+0x12345678] ; volume translate right sample
+        add     eax, edx                     ; mix left sample
+fpatch6:
+        mov     dl, byte [edi+0x12345678]   ; get current sample from destination
+fpatch4:
+        mov     eax, [eax + 0x12345678]      ; harsh clip left sample
+        add     ebx, edx                     ; mix right sample
+        mov     [edi], al                    ; write left sample to destination
+fpatch5:
+        mov     ebx, [ebx + 0x12345678]      ; harsh clip right sample
+        inc     esi                          ; move source to next sample
+fpatch7:
+        mov     [edi+0x12345678], bl         ; write right sample to destination
+        inc     edi                          ; move destination to next sample
+        xor     ebx, ebx
+        dec     ecx                          ; decrement count
+        jnz     short mix8U1xloop            ; loop
+
+        mov     [_MV_MixDestination], edi    ; Store the current write position
+        mov     [_MV_MixPosition], ebp       ; return position
+
+exit8U1x:
+        pop	ebp
+	pop	edi
+	pop	esi
+	pop	edx
+	pop	ecx
+	pop	ebx
+        ret
+
+CPU 586
+
+;================
+;
+; MV_Mix8BitMonoMMX
+;
+;================
+
+; MMX version of MV_Mix8BitMono, mixes four samples at once.
+; The destination is flipped to signed so a saturating packed
+; add does the job of the harsh clip table.
+
+; eax - position
+; edx - rate
+; ebx - start
+; ecx - number of samples to mix
+
+CODE_SYM_DEF MV_Mix8BitMonoMMX
+        push	ebx
+	push	ecx
+	push	edx
+	push	esi
+	push	edi
+	push	ebp
+
+        mov     ebp, eax
+
+        mov     esi, ebx ; Source pointer
+
+        ; Volume table ptr
+        mov     ebx,[_MV_LeftVolume] ; Since we're mono, use left volume
+        mov     eax,gpatch5+3
+        mov     [eax],ebx
+        mov     eax,gpatch6+3
+        mov     [eax],ebx
+        mov     eax,gpatch7+3
+        mov     [eax],ebx
+        mov     eax,gpatch8+3
+        mov     [eax],ebx
+
+        ; Rate scale ptr
+        mov     eax,gpatch1+2
+        mov     [eax],edx
+        mov     eax,gpatch2+2
+        mov     [eax],edx
+        mov     eax,gpatch3+2
+        mov     [eax],edx
+        mov     eax,gpatch4+2
+        mov     [eax],edx
+
+        mov     edi,[_MV_MixDestination] ; Get the position to write to
+
+        ; Like MV_Mix8BitMono, leave everything alone below two samples
+        cmp     ecx, 2
+        jb      done8MMMX
+
+        mov     eax, 0x80808080
+        movd    mm7, eax                        ; sign flip mask
+
+        ; Number of samples to mix
+        shr     ecx, 2 ; quad sample count
+        je      tail8MMMX
+
+;     eax - scratch
+;     ebx - scratch
+;     edx - four mixed samples
+;     ecx - count
+;     edi - destination
+;     esi - source
+;     ebp - frac pointer
+;     mm7 - sign flip mask
+; gpatch1 - sample rate
+; gpatch2 - sample rate
+; gpatch3 - sample rate
+; gpatch4 - sample rate
+; gpatch5 - volume table
+; gpatch6 - volume table
+; gpatch7 - volume table
+; gpatch8 - volume table
+
+        align 4
+mix8MMMXloop:
+        mov     eax, ebp                        ; begin calculating first sample
+        shr     eax, 16                         ; finish calculation for first sample
+gpatch1:
+        add     ebp, 0x12345678                 ; advance frac pointer
+        mov     ebx, ebp                        ; begin calculating second sample
+        shr     ebx, 16                         ; finish calculation for second sample
+gpatch2:
+        add     ebp, 0x12345678                 ; advance frac pointer
+        movzx   eax, byte [esi+eax]             ; get first sample
+        movzx   ebx, byte [esi+ebx]             ; get second sample
+gpatch5:
+        mov     dl, byte [2*eax+0x12345678]     ; volume translate first sample
+gpatch6:
+        mov     dh, byte [2*ebx+0x12345678]     ; volume translate second sample
+        mov     eax, ebp                        ; begin calculating third sample
+        shr     eax, 16                         ; finish calculation for third sample
+gpatch3:
+        add     ebp, 0x12345678                 ; advance frac pointer
+        mov     ebx, ebp                        ; begin calculating fourth sample
+        shr     ebx, 16                         ; finish calculation for fourth sample
+gpatch4:
+        add     ebp, 0x12345678                 ; advance frac pointer
+        movzx   eax, byte [esi+eax]             ; get third sample
+        movzx   ebx, byte [esi+ebx]             ; get fourth sample
+        ror     edx, 16                         ; move first and second samples to the high word
+gpatch7:
+        mov     dl, byte [2*eax+0x12345678]     ; volume translate third sample
+gpatch8:
+        mov     dh, byte [2*ebx+0x12345678]     ; volume translate fourth sample
+        ror     edx, 16                         ; put the four samples in order
+        movd    mm0, edx
+        movd    mm1, [edi]                      ; get four samples from destination
+        pxor    mm1, mm7                        ; make them signed
+        paddsb  mm1, mm0                        ; mix and clip
+        pxor    mm1, mm7                        ; back to unsigned
+        movd    [edi], mm1                      ; write new samples to destination
+        add     edi, 4                          ; move destination to fifth sample
+        dec     ecx                             ; decrement count
+        jnz     mix8MMMXloop                    ; loop
+
+tail8MMMX:
+        ; Up to three samples left, mixed one at a time
+        mov     ecx, [esp+16]                   ; number of samples to mix
+        and     ecx, 3
+        je      short exit8MMMX
+
+        mov     ebx, [_MV_LeftVolume]
+
+mix8MMMXtail:
+        mov     eax, ebp                        ; begin calculating sample
+        shr     eax, 16                         ; finish calculation for sample
+        add     ebp, [esp+12]                   ; advance frac pointer
+        movzx   eax, byte [esi+eax]             ; get sample
+        movzx   edx, byte [ebx+2*eax]           ; volume translate sample
+        movd    mm0, edx
+        movzx   eax, byte [edi]                 ; get current sample from destination
+        movd    mm1, eax
+        pxor    mm1, mm7
+        paddsb  mm1, mm0
+        pxor    mm1, mm7
+        movd    eax, mm1
+        mov     [edi], al                       ; write new sample to destination
+        inc     edi
+        dec     ecx
+        jnz     short mix8MMMXtail
+
+exit8MMMX:
+        emms
+
+        ; MV_Mix8BitMono ends two samples past the last even one it
+        ; mixed, end the frac pointer there too
+        test    byte [esp+16], 1                ; odd number of samples?
+        jnz     short odd8MMMX
+        add     ebp, [esp+12]                   ; advance frac pointer
+odd8MMMX:
+        add     ebp, [esp+12]                   ; advance frac pointer
+
+        mov     [_MV_MixDestination], edi       ; Store the current write position
+        mov     [_MV_MixPosition], ebp          ; return position
+
+done8MMMX:
+        pop	ebp
+	pop	edi
+	pop	esi
+	pop	edx
+	pop	ecx
+	pop	ebx
+        ret
+
+;================
+;
+; MV_Mix8BitStereoMMX
+;
+;================
+
+; MMX version of MV_Mix8BitStereo, mixes two left and right
+; sample pairs at once.
+
+; eax - position
+; edx - rate
+; ebx - start
+; ecx - number of samples to mix
+
+CODE_SYM_DEF MV_Mix8BitStereoMMX
+        push	ebx
+	push	ecx
+	push	edx
+	push	esi
+	push	edi
+	push	ebp
+
+        mov     ebp, eax
+
+        mov     esi, ebx ; Source pointer
+
+        ; Volume table ptr
+        mov     ebx, [_MV_LeftVolume]
+        mov     eax, hpatch3+3
+        mov     [eax],ebx
+        mov     eax, hpatch5+3
+        mov     [eax],ebx
+
+        mov     ebx, [_MV_RightVolume]
+        mov     eax, hpatch4+3
+        mov     [eax],ebx
+        mov     eax, hpatch6+3
+        mov     [eax],ebx
+
+        ; Rate scale ptr
+        mov     eax, hpatch1+2
+        mov     [eax],edx
+        mov     eax, hpatch2+2
+        mov     [eax],edx
+
+        mov     edi, [_MV_MixDestination] ; Get the position to write to
+
+        mov     eax, 0x80808080
+        movd    mm7, eax                     ; sign flip mask
+
+        ; Number of samples to mix
+        shr     ecx, 1 ; double sample count
+        je      tail8SMMX
+
+;     eax - scratch
+;     ebx - scratch
+;     edx - two mixed sample pairs
+;     ecx - count
+;     edi - destination
+;     esi - source
+;     ebp - frac pointer
+;     mm7 - sign flip mask
+; hpatch1 - sample rate
+; hpatch2 - sample rate
+; hpatch3 - left volume table
+; hpatch4 - right volume table
+; hpatch5 - left volume table
+; hpatch6 - right volume table
+
+        align 4
+mix8SMMXloop:
+        mov     eax, ebp                     ; begin calculating first sample
+        shr     eax, 16                      ; finish calculation for first sample
+hpatch1:
+        add     ebp, 0x12345678              ; advance frac pointer
+        mov     ebx, ebp                     ; begin calculating second sample
+        shr     ebx, 16                      ; finish calculation for second sample
+hpatch2:
+        add     ebp, 0x12345678              ; advance frac pointer
+        movzx   eax, byte [esi+eax]          ; get first sample
+        movzx   ebx, byte [esi+ebx]          ; get second sample
+hpatch3:
+        mov     dl, byte [2*ebx+0x12345678]  ; volume translate second left sample
+hpatch4:
+        mov     dh, byte [2*ebx+0x12345678]  ; volume translate second right sample
+        shl     edx, 16                      ; second pair goes in the high word
+hpatch5:
+        mov     dl, byte [2*eax+0x12345678]  ; volume translate first left sample
+hpatch6:
+        mov     dh, byte [2*eax+0x12345678]  ; volume translate first right sample
+        movd    mm0, edx
+        movd    mm1, [edi]                   ; get two sample pairs from destination
+        pxor    mm1, mm7                     ; make them signed
+        paddsb  mm1, mm0                     ; mix and clip
+        pxor    mm1, mm7                     ; back to unsigned
+        movd    [edi], mm1                   ; write new samples to destination
+        add     edi, 4                       ; move destination to third sample
+        dec     ecx                          ; decrement count
+        jnz     mix8SMMXloop                 ; loop
+
+tail8SMMX:
+        ; One sample left
+        test    byte [esp+16], 1             ; number of samples to mix
+        je      short exit8SMMX
+
+        mov     eax, ebp                     ; begin calculating sample
+        shr     eax, 16                      ; finish calculation for sample
+        add     ebp, [esp+12]                ; advance frac pointer
+        movzx   eax, byte [esi+eax]          ; get sample
+        mov     ebx, [_MV_LeftVolume]
+        mov     dl, byte [ebx+2*eax]         ; volume translate left sample
+        mov     ebx, [_MV_RightVolume]
+        mov     dh, byte [ebx+2*eax]         ; volume translate right sample
+        movzx   edx, dx
+        movd    mm0, edx
+        movzx   eax, word [edi]              ; get current samples from destination
+        movd    mm1, eax
+        pxor    mm1, mm7
+        paddsb  mm1, mm0
+        pxor    mm1, mm7
+        movd    eax, mm1
+        mov     [edi], ax                    ; write new samples to destination
+        add     edi, 2
+
+exit8SMMX:
+        emms
+        mov     [_MV_MixDestination], edi    ; Store the current write position
+        mov     [_MV_MixPosition], ebp       ; return position
+
+        pop	ebp
+	pop	edi
+	pop	esi
+	pop	edx
+	pop	ecx
+	pop	ebx
+        ret
+
+CPU 486
@@ -165,4 +165,13 @@ void MV_Mix8BitMono(unsigned long position, unsigned long rate, unsigned char *s
 void MV_Mix8BitStereo(unsigned long position, unsigned long rate, unsigned char *start, unsigned long length);
 void MV_Mix8BitUltrasound(unsigned long position, unsigned long rate, unsigned char *start, unsigned long length);
 
+// Sounds at the mix rate (RateScale == 0x10000)
+void MV_Mix8BitMono1x(unsigned long position, unsigned long rate, unsigned char *start, unsigned long length);
+void MV_Mix8BitStereo1x(unsigned long position, unsigned long rate, unsigned char *start, unsigned long length);
+void MV_Mix8BitUltrasound1x(unsigned long position, unsigned long rate, unsigned char *start, unsigned long length);
+
+// Pentium MMX and later, for any rate
+void MV_Mix8BitMonoMMX(unsigned long position, unsigned long rate, unsigned char *start, unsigned long length);
+void MV_Mix8BitStereoMMX(unsigned long position, unsigned long rate, unsigned char *start, unsigned long length);
+
 #endif
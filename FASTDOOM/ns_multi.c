@@ -27,6 +27,7 @@
 #include "ns_fxm.h"
 #include "dmx.h"
 #include "z_zone.h"
+#include "i_cpu.h"
 
 #define RoundFixed(fixedval, bits)             \
     (                                          \
@@ -54,6 +55,7 @@ static int MV_Bits = 8;
 
 static int MV_Silence = SILENCE_8BIT;
 static int MV_SwapLeftRight = FALSE;
+static int MV_UseMMX = FALSE;
 
 static int MV_RequestedMixRate;
 static int MV_MixRate;
@@ -82,6 +84,8 @@ short *MV_RightVolume;
 int MV_SampleSize = 1;
 int MV_RightChannelOffset;
 
+isrprofile_t MV_ISRProfile;
+
 unsigned long RateScale11025 = 0;
 unsigned long RateScale22050 = 0;
 unsigned long RateScale44100 = 0;
@@ -234,6 +238,9 @@ void MV_ServiceVoc(
     VoiceNode *voice;
     VoiceNode *next;
     char *buffer;
+    unsigned int start;
+
+    start = I_StartProfileISR();
 
     if (MV_DMAChannel >= 0)
     {
@@ -279,6 +286,8 @@ void MV_ServiceVoc(
             MV_StopVoice(voice);
         }
     }
+
+    I_EndProfileISR(&MV_ISRProfile, start);
 }
 
 int leftpage = -1;
@@ -538,6 +547,13 @@ VoiceNode *MV_AllocVoice(
 
 void MV_SetVoicePitch(VoiceNode *voice, unsigned long rate)
 {
+    if (rate == MV_MixRate)
+    {
+        voice->RateScale = 0x10000;
+        voice->FixedPointBufferSize = (0x10000 * MixBufferSize) - 0x10000;
+        return;
+    }
+
     switch (rate)
     {
     case 11025:
@@ -554,6 +570,17 @@ void MV_SetVoicePitch(VoiceNode *voice, unsigned long rate)
     }
 }
 
+/*---------------------------------------------------------------------
+   Function: MV_GetMixRate
+
+   Returns the rate the voices are mixed at.
+---------------------------------------------------------------------*/
+
+int MV_GetMixRate(void)
+{
+    return MV_MixRate;
+}
+
 /*---------------------------------------------------------------------
    Function: MV_GetVolumeTable
 
@@ -602,17 +629,44 @@ static void MV_SetVoiceMixMode(
         test |= T_ULTRASOUND;
     }
 
-    switch (test)
+    if (MV_UseMMX && !(test & T_ULTRASOUND))
     {
-    case T_8BITS | T_MONO:
-        voice->mix = MV_Mix8BitMono;
-        break;
-    case T_8BITS:
-        voice->mix = MV_Mix8BitStereo;
-        break;
-    default:
-        // Ultrasound
-        voice->mix = MV_Mix8BitUltrasound;
+        // Packed saturating mix, for any rate
+        if (test & T_MONO)
+            voice->mix = MV_Mix8BitMonoMMX;
+        else
+            voice->mix = MV_Mix8BitStereoMMX;
+    }
+    else if (voice->RateScale == 0x10000)
+    {
+        // No resampling needed
+        switch (test)
+        {
+        case T_8BITS | T_MONO:
+            voice->mix = MV_Mix8BitMono1x;
+            break;
+        case T_8BITS:
+            voice->mix = MV_Mix8BitStereo1x;
+            break;
+        default:
+            // Ultrasound
+            voice->mix = MV_Mix8BitUltrasound1x;
+        }
+    }
+    else
+    {
+        switch (test)
+        {
+        case T_8BITS | T_MONO:
+            voice->mix = MV_Mix8BitMono;
+            break;
+        case T_8BITS:
+            voice->mix = MV_Mix8BitStereo;
+            break;
+        default:
+            // Ultrasound
+            voice->mix = MV_Mix8BitUltrasound;
+        }
     }
 
     RestoreInterrupts(flags);
@@ -1166,6 +1220,9 @@ int MV_Init(
     // Set number of voices before calculating volume table
     MV_MaxVoices = Voices;
 
+    // Mix with packed adds instead of the harsh clip table
+    MV_UseMMX = I_CPUHasFeature(CPU_FEATURE_MMX);
+
     LL_Reset(&VoiceList, next, prev);
     LL_Reset(&VoicePool, next, prev);
 
@@ -1,10 +1,15 @@
 #ifndef __MULTIVOC_H
 #define __MULTIVOC_H
 
+#include "i_cpu.h"
+
 #define MV_MinVoiceHandle 1
 
 extern int MV_RightChannelOffset;
 
+// Time spent mixing the next sound buffer
+extern isrprofile_t MV_ISRProfile;
+
 enum MV_Errors
 {
     MV_Warning = -2,
@@ -41,6 +46,7 @@ int MV_PlayRaw(unsigned char *ptr, unsigned long length,
                int right, int priority);
 void MV_CreateVolumeTable(int index, int volume, int MaxVolume);
 void MV_SetVolume(int volume);
+int MV_GetMixRate(void);
 void MV_SetReverseStereo(int setting);
 void MV_ReverseStereo(void);
 int MV_Init(int soundcard, int MixRate, int Voices, int numchannels);
@@ -2,6 +2,7 @@
 #include <dos.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include "ns_inter.h"
 #include "ns_cards.h"
 #include "ns_sb.h"
@@ -113,6 +114,16 @@ static int AL_MaxMidiChannel = 16;
 static int AL_OPL2LPT = FALSE;
 static int AL_OPL3LPT = FALSE;
 
+// Last value written to each register plus one, zero if unknown.
+// Indexed by chip (base or base + 2) and register, OPL3LPT
+// selects the second register array with bit 8.
+#define AL_SHADOW_SIZE 0x200
+static unsigned short AL_Shadow[2][AL_SHADOW_SIZE];
+
+unsigned int AL_PortWrites;
+unsigned int AL_SkippedWrites;
+unsigned int AL_DelayReads;
+
 void AL_SendOutputToPort_OPL2LPT(int port, int reg, int data)
 {
    int i;
@@ -200,17 +211,41 @@ void AL_SendOutputToPort_OPL3LPT(int port, int reg, int data)
 void AL_SendOutputToPort(int port, int reg, int data)
 {
    int delay;
+   unsigned short value;
+   unsigned short *shadow;
+
+   // Skip writes that don't change the register. Register 4
+   // (timer control, IRQ reset) is a command and always goes out.
+   if ((reg & 0xFF) != 4)
+   {
+      value = (data & 0xFF) + 1;
+      shadow = &AL_Shadow[(port >> 1) & 1][reg & (AL_SHADOW_SIZE - 1)];
+
+      if (*shadow == value)
+      {
+         AL_SkippedWrites++;
+         return;
+      }
+
+      *shadow = value;
+   }
+
+   AL_PortWrites++;
 
    if (AL_OPL2LPT)
    {
       AL_SendOutputToPort_OPL2LPT(port, reg, data);
+      AL_DelayReads += 6 + 35;
       return;
    } else if (AL_OPL3LPT)
    {
       AL_SendOutputToPort_OPL3LPT(port, reg, data);
+      AL_DelayReads += 6 + 6;
       return;
    }
 
+   AL_DelayReads += 6 + 27;
+
    outp(port, reg);
 
    for (delay = 6; delay > 0; delay--)
@@ -230,6 +265,18 @@ void AL_SendOutputToPort(int port, int reg, int data)
 }
 
 
+/*---------------------------------------------------------------------
+   Function: AL_ClearShadow
+
+   Forgets the register values, so the next writes are sent even if
+   they match what was written before.
+---------------------------------------------------------------------*/
+
+void AL_ClearShadow(void)
+{
+   memset(AL_Shadow, 0, sizeof(AL_Shadow));
+}
+
 /*---------------------------------------------------------------------
    Function: AL_SendOutput
 
@@ -844,6 +891,8 @@ void AL_Reset(
     void)
 
 {
+   AL_ClearShadow();
+
    AL_SendOutputToPort(ADLIB_PORT, 1, 0x20);
    AL_SendOutputToPort(ADLIB_PORT, 0x08, 0);
 
@@ -15,10 +15,17 @@ enum AL_Errors
 
 extern int ADLIB_PORT;
 
+// Register writes sent, writes skipped because the register already
+// had the value, and port reads spent waiting for the chip
+extern unsigned int AL_PortWrites;
+extern unsigned int AL_SkippedWrites;
+extern unsigned int AL_DelayReads;
+
 void AL_SendOutputToPort(int port, int reg, int data);
 void AL_SendOutputToPort_OPL2LPT(int port, int reg, int data);
 void AL_SendOutputToPort_OPL3LPT(int port, int reg, int data);
 void AL_SendOutput(int voice, int reg, int data);
+void AL_ClearShadow(void);
 void AL_StereoOn(void);
 void AL_StereoOff(void);
 void AL_Shutdown(void);
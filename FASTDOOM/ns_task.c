@@ -50,6 +50,9 @@ static void(__interrupt __far *OldInt8)(void);
 static volatile long TaskServiceRate = 0x10000L;
 static volatile long TaskServiceCount = 0;
 
+// PIT input clocks of the timer periods that have ended
+static volatile unsigned long TS_PITClock = 0;
+
 #ifndef NOINTS
 static volatile int TS_TimesInInterrupt;
 #endif
@@ -58,6 +61,8 @@ static char TS_Installed = FALSE;
 
 volatile int TS_InInterrupt = FALSE;
 
+isrprofile_t TS_ISRProfile;
+
 /*---------------------------------------------------------------------
    Function prototypes
 ---------------------------------------------------------------------*/
@@ -183,15 +188,20 @@ static void __interrupt __far TS_ServiceSchedule(void)
 {
     task *ptr;
     task *next;
+    unsigned int start;
 
     TS_InInterrupt = TRUE;
 
+    TS_PITClock += TaskServiceRate;
+
     // save stack
     GetStack(&oldStackSelector, &oldStackPointer);
 
     // set our stack
     SetStack(StackSelector, StackPointer);
 
+    start = I_StartProfileISR();
+
     ptr = TaskList->next;
     while (ptr != TaskList)
     {
@@ -211,6 +221,8 @@ static void __interrupt __far TS_ServiceSchedule(void)
         ptr = next;
     }
 
+    I_EndProfileISR(&TS_ISRProfile, start);
+
     // restore stack
     SetStack(oldStackSelector, oldStackPointer);
 
@@ -232,8 +244,10 @@ static void __interrupt __far TS_ServiceScheduleIntEnabled(void)
 {
     task *ptr;
     task *next;
+    unsigned int start;
 
     TS_TimesInInterrupt++;
+    TS_PITClock += TaskServiceRate;
     TaskServiceCount += TaskServiceRate;
     if (TaskServiceCount > 0xffffL)
     {
@@ -257,6 +271,8 @@ static void __interrupt __far TS_ServiceScheduleIntEnabled(void)
     // set our stack
     SetStack(StackSelector, StackPointer);
 
+    start = I_StartProfileISR();
+
     while (TS_TimesInInterrupt)
     {
         ptr = TaskList->next;
@@ -280,6 +296,8 @@ static void __interrupt __far TS_ServiceScheduleIntEnabled(void)
 
     _disable();
 
+    I_EndProfileISR(&TS_ISRProfile, start);
+
     // restore stack
     SetStack(oldStackSelector, oldStackPointer);
 
@@ -287,6 +305,61 @@ static void __interrupt __far TS_ServiceScheduleIntEnabled(void)
 }
 #endif
 
+/*---------------------------------------------------------------------
+   Function: TS_ReadPITClock
+
+   Returns the PIT input clocks (1193182Hz) elapsed since the scheduler
+   was installed, using the running count of channel 0 for the part of
+   the current timer period.
+---------------------------------------------------------------------*/
+
+unsigned int TS_ReadPITClock(void)
+{
+    unsigned flags;
+    unsigned int clock;
+    unsigned int period;
+    unsigned int count;
+    int status;
+    int pending;
+
+    flags = DisableInterrupts();
+
+    // An IRQ 0 that is waiting to be serviced has already reloaded the
+    // counter without adding its period, retry if it fires meanwhile
+    do
+    {
+        outp(0x20, 0x0A);
+        pending = inp(0x20) & 1;
+
+        // Read-back command, latch status and count of channel 0
+        outp(0x43, 0xC2);
+        status = inp(0x40);
+        count = inp(0x40);
+        count |= inp(0x40) << 8;
+
+        outp(0x20, 0x0A);
+    } while ((inp(0x20) & 1) != pending);
+
+    clock = TS_PITClock;
+    period = TaskServiceRate;
+
+    if (count == 0)
+        count = 0x10000;
+
+    // Mode 3 counts down twice per period, two clocks per step,
+    // with OUT high during the first half
+    clock += (period - count) >> 1;
+    if (!(status & 0x80))
+        clock += period >> 1;
+
+    if (pending)
+        clock += period;
+
+    RestoreInterrupts(flags);
+
+    return clock;
+}
+
 /*---------------------------------------------------------------------
    Function: allocateTimerStack
 
@@ -1,6 +1,8 @@
 #ifndef __TASK_MAN_H
 #define __TASK_MAN_H
 
+#include "i_cpu.h"
+
 enum TASK_ERRORS
 {
    TASK_Warning = -2,
@@ -26,11 +28,15 @@ typedef struct task
 
 extern volatile int TS_InInterrupt;
 
+// Time spent running the tasks from the timer interrupt
+extern isrprofile_t TS_ISRProfile;
+
 void TS_Shutdown(void);
 task *TS_ScheduleTask(void (*Function)(task *), int rate,
                       int priority, void *data);
 int TS_Terminate(task *ptr);
 void TS_Dispatch(void);
 void TS_SetTaskRate(task *Task, int rate);
+unsigned int TS_ReadPITClock(void);
 
 #endif
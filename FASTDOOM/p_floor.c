@@ -45,6 +45,9 @@ result_e T_MovePlane(sector_t *sector, fixed_t speed, fixed_t dest, byte crush,
 {
 	fixed_t lastpos;
 
+	// Cached sight checks may go through this sector
+	P_FlushSightCache();
+
 	switch (floorOrCeiling)
 	{
 	case 0:
@@ -62,7 +62,22 @@
 // both the head and tail of the thinker list
 extern thinker_t thinkercap;
 
+// both the head and tail of the tickless mobj list
+extern thinker_t staticthinkercap;
+
+extern int numstaticthinkers;
+extern int numrunthinkers;
+extern int numdormantthinkers;
+
+// Profiling clock ticks spent per subsystem, see I_ReadProfileClock
+extern unsigned int playerthinktime;
+extern unsigned int runthinkerstime;
+extern unsigned int updatespecialstime;
+
 void P_InitThinkers(void);
+void P_ResetPlaysimProfile(void);
+void P_AddStaticThinker(thinker_t *thinker);
+void P_ActivateStaticThinker(thinker_t *thinker);
 
 //
 // P_PSPR
@@ -182,6 +197,15 @@ byte P_TryMove(mobj_t *thing, fixed_t x, fixed_t y);
 byte P_TeleportMove(mobj_t *thing, fixed_t x, fixed_t y);
 void P_SlideMove(mobj_t *mo);
 byte P_CheckSight(mobj_t *t1, mobj_t *t2);
+
+// Sight checks are cached while sightstamp doesn't change
+extern unsigned int sightstamp;
+#define P_FlushSightCache() (sightstamp++)
+
+extern unsigned int sightchecks;
+extern unsigned int sightrejects;
+extern unsigned int sightwalks;
+extern unsigned int sightcachehits;
 void P_UseLines(void);
 
 byte P_ChangeSector(sector_t *sector, byte crunch);
@@ -407,6 +407,31 @@ intercept_t *intercept_p;
 
 divline_t trace;
 
+//
+// P_InsertIntercept
+// Keeps the intercepts sorted by frac, so P_TraverseIntercepts
+// can walk them in order. Intercepts with the same frac keep
+// the order they were added in, like the old selection scan.
+//
+static intercept_t *P_InsertIntercept(fixed_t frac)
+{
+    intercept_t *in;
+
+    in = intercept_p++;
+
+    // traces are walked block by block away from the source,
+    // so new intercepts usually belong at the end
+    while (in > intercepts && (in - 1)->frac > frac)
+    {
+        *in = *(in - 1);
+        in--;
+    }
+
+    in->frac = frac;
+
+    return in;
+}
+
 //
 // PIT_AddLineIntercepts.
 // Looks for lines in the given block
@@ -422,6 +447,7 @@ byte PIT_AddLineIntercepts(line_t *ld)
     byte s1;
     byte s2;
     fixed_t frac;
+    intercept_t *in;
 
     // avoid precision problems with two routines
     if (trace.dx > FRACUNIT * 16 || trace.dy > FRACUNIT * 16 || trace.dx < -FRACUNIT * 16 || trace.dy < -FRACUNIT * 16)
@@ -445,10 +471,12 @@ byte PIT_AddLineIntercepts(line_t *ld)
     if (frac < 0)
         return 1; // behind source
 
-    intercept_p->frac = frac;
-    intercept_p->isaline = 1;
-    intercept_p->d.line = ld;
-    intercept_p++;
+    if (frac > FRACUNIT)
+        return 1; // never reached by P_TraverseIntercepts
+
+    in = P_InsertIntercept(frac);
+    in->isaline = 1;
+    in->d.line = ld;
 
     return 1; // continue
 }
@@ -471,6 +499,7 @@ byte PIT_AddThingIntercepts(mobj_t *thing)
     divline_t dl;
 
     fixed_t frac;
+    intercept_t *in;
 
     if (!((thing->flags & MF_SHOOTABLE)))
         return 1; // not shootable
@@ -507,10 +536,12 @@ byte PIT_AddThingIntercepts(mobj_t *thing)
     if (frac < 0)
         return 1; // behind source
 
-    intercept_p->frac = frac;
-    intercept_p->isaline = 0;
-    intercept_p->d.thing = thing;
-    intercept_p++;
+    if (frac > FRACUNIT)
+        return 1; // never reached by P_TraverseIntercepts
+
+    in = P_InsertIntercept(frac);
+    in->isaline = 0;
+    in->d.thing = thing;
 
     return 1; // keep going
 }
@@ -522,28 +553,14 @@ byte PIT_AddThingIntercepts(mobj_t *thing)
 //
 void P_TraverseIntercepts(traverser_t func)
 {
-    int count;
-    count = intercept_p - intercepts;
+    intercept_t *in;
 
-    while (count--)
+    // intercepts are already sorted by frac,
+    // and the ones past the end of the trace were never added
+    for (in = intercepts; in < intercept_p; in++)
     {
-        fixed_t dist = MAXINT;
-        intercept_t *scan;
-        intercept_t *in;
-
-        for (scan = intercepts; scan < intercept_p; scan++)
-        {
-            if (scan->frac < dist)
-            {
-                dist = scan->frac;
-                in = scan;
-            }
-        }
-
-        if (dist > FRACUNIT || !func(in))
-            return; // checked everything in range, don't bother going farther
-
-        in->frac = MAXINT;
+        if (!func(in))
+            return;
     }
 
     return; // everything was traversed
@@ -500,7 +500,11 @@ P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, byte type)
         if (mobj->tics != -1)
             mobj->thinker.function.acp1 = (actionf_p1)P_MobjBrainlessThinker;
         else
+        {
             mobj->thinker.function.acp1 = (actionf_p1)P_MobjTicklessThinker;
+            P_AddStaticThinker(&mobj->thinker);
+            return mobj;
+        }
     }
 
     thinkercap.prev->next = &mobj->thinker;
@@ -522,6 +526,10 @@ void P_RemoveMobj(mobj_t *mobj)
     // stop any playing sound
     S_StopSound(mobj);
 
+    // let P_RunThinkers free it
+    if (mobj->thinker.function.acp1 == (actionf_p1)P_MobjTicklessThinker)
+        P_ActivateStaticThinker(&mobj->thinker);
+
     // free block
     mobj->thinker.function.acv = (actionf_v)(-1);
 }
@@ -195,33 +195,43 @@ typedef enum
 
 } thinkerclass_t;
 
+static void P_ArchiveMobj(thinker_t *th)
+{
+	mobj_t *mobj;
+
+	*save_p++ = tc_mobj;
+	PADSAVEP();
+	mobj = (mobj_t *)save_p;
+	CopyBytes(th, mobj, sizeof(*mobj));
+	//memcpy(mobj, th, sizeof(*mobj));
+	save_p += sizeof(*mobj);
+	mobj->state = (state_t *)(mobj->state - states);
+
+	if (mobj->player)
+		mobj->player = (player_t *)(mobj->player);
+}
+
 //
 // P_ArchiveThinkers
 //
 void P_ArchiveThinkers(void)
 {
 	thinker_t *th;
-	mobj_t *mobj;
 
 	// save off the current thinkers
 	for (th = thinkercap.next; th != &thinkercap; th = th->next)
 	{
 		if (th->function.acp1 == (actionf_p1)P_MobjThinker || th->function.acp1 == (actionf_p1)P_MobjBrainlessThinker || th->function.acp1 == (actionf_p1)P_MobjTicklessThinker)
 		{
-			*save_p++ = tc_mobj;
-			PADSAVEP();
-			mobj = (mobj_t *)save_p;
-			CopyBytes(th, mobj, sizeof(*mobj));
-			//memcpy(mobj, th, sizeof(*mobj));
-			save_p += sizeof(*mobj);
-			mobj->state = (state_t *)(mobj->state - states);
-
-			if (mobj->player)
-				mobj->player = (player_t *)(mobj->player);
+			P_ArchiveMobj(th);
 			continue;
 		}
 	}
 
+	// the static list only holds mobjs
+	for (th = staticthinkercap.next; th != &staticthinkercap; th = th->next)
+		P_ArchiveMobj(th);
+
 	// add a terminating marker
 	*save_p++ = tc_end;
 }
@@ -237,6 +247,10 @@ void P_UnArchiveThinkers(void)
 	mobj_t *mobj;
 
 	// remove all the current thinkers
+	// (removed static mobjs are moved to the main list)
+	while (staticthinkercap.next != &staticthinkercap)
+		P_RemoveMobj((mobj_t *)staticthinkercap.next);
+
 	currentthinker = thinkercap.next;
 	while (currentthinker != &thinkercap)
 	{
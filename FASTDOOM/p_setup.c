@@ -48,6 +48,7 @@ void P_SpawnMapThing(mapthing_t *mthing);
 int numvertexes;
 vertex_t *vertexes;
 
+int numsegs;
 seg_t *segs;
 
 int numsectors;
@@ -142,7 +143,6 @@ void P_LoadSegs(int lump)
     line_t *ldef;
     int linedef;
     int side;
-    int numsegs;
 
     numsegs = W_LumpLength(lump) / sizeof(mapseg_t);
     segs = Z_MallocUnowned(numsegs * sizeof(seg_t), PU_LEVEL);
@@ -623,6 +623,9 @@ void P_SetupLevel(int episode,
     P_LoadNodes(lumpnum + ML_NODES);
     P_LoadSegs(lumpnum + ML_SEGS);
 
+    R_LoadRenderBSP();
+    R_LoadPVS(lumpname);
+
     rejectmatrix = W_CacheLumpNum(lumpnum + ML_REJECT, PU_LEVEL);
     P_GroupLines();
 
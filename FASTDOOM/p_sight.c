@@ -40,6 +40,33 @@ divline_t strace; // from t1 to t2
 fixed_t t2x;
 fixed_t t2y;
 
+//
+// Sight cache
+// Monsters often check the same target several times per tic.
+// The result only depends on both positions and on the map
+// geometry, so it is reused until the tic ends or a plane moves.
+//
+#define SIGHTCACHE_SIZE 128
+
+typedef struct
+{
+    mobj_t *t1;
+    mobj_t *t2;
+    fixed_t x1, y1, z1, h1;
+    fixed_t x2, y2, z2, h2;
+    unsigned int stamp;
+    byte result;
+} sightcache_t;
+
+static sightcache_t sightcache[SIGHTCACHE_SIZE];
+
+unsigned int sightstamp = 1;
+
+unsigned int sightchecks;
+unsigned int sightrejects;
+unsigned int sightwalks;
+unsigned int sightcachehits;
+
 //
 // P_CrossSubsector
 // Returns true
@@ -306,6 +333,7 @@ byte P_CheckSight(mobj_t *t1, mobj_t *t2)
     int pnum;
     int bytenum;
     int bitnum;
+    sightcache_t *cache;
 
     // First check for trivial rejection.
 
@@ -318,13 +346,26 @@ byte P_CheckSight(mobj_t *t1, mobj_t *t2)
     bytenum = pnum >> 3;
     bitnum = 1 << (pnum & 7);
 
+    sightchecks++;
+
     // Check in REJECT table.
     if (rejectmatrix[bytenum] & bitnum)
     {
         // can't possibly be connected
+        sightrejects++;
         return 0;
     }
 
+    cache = &sightcache[(((unsigned int)t1 >> 3) ^ ((unsigned int)t2 >> 5)) & (SIGHTCACHE_SIZE - 1)];
+
+    if (cache->stamp == sightstamp && cache->t1 == t1 && cache->t2 == t2 &&
+        cache->x1 == t1->x && cache->y1 == t1->y && cache->z1 == t1->z && cache->h1 == t1->height &&
+        cache->x2 == t2->x && cache->y2 == t2->y && cache->z2 == t2->z && cache->h2 == t2->height)
+    {
+        sightcachehits++;
+        return cache->result;
+    }
+
     // An unobstructed LOS is possible.
     // Now look from eyes of t1 to any part of t2.
 
@@ -349,5 +390,20 @@ byte P_CheckSight(mobj_t *t1, mobj_t *t2)
         strace.type = 2;
 
     // the head node is the last node output
-    return P_CrossBSPNode(firstnode);
+    sightwalks++;
+
+    cache->t1 = t1;
+    cache->t2 = t2;
+    cache->x1 = t1->x;
+    cache->y1 = t1->y;
+    cache->z1 = t1->z;
+    cache->h1 = t1->height;
+    cache->x2 = t2->x;
+    cache->y2 = t2->y;
+    cache->z2 = t2->z;
+    cache->h2 = t2->height;
+    cache->stamp = sightstamp;
+    cache->result = P_CrossBSPNode(firstnode);
+
+    return cache->result;
 }
@@ -359,6 +359,7 @@ int P_FindMinSurroundingLight(sector_t *sector)
 // P_CrossSpecialLine - TRIGGER
 // Called every time a thing origin is about
 //  to cross a line with a non 0 special.
+// The sounds of new specials go in S_MarkLineSfx.
 //
 void P_CrossSpecialLine(int linenum, byte side, mobj_t *thing)
 {
@@ -816,6 +817,7 @@ void P_CrossSpecialLine(int linenum, byte side, mobj_t *thing)
 //
 // P_ShootSpecialLine - IMPACT SPECIALS
 // Called when a thing shoots a special line.
+// The sounds of new specials go in S_MarkLineSfx.
 //
 void P_ShootSpecialLine(mobj_t *thing,
 						line_t *line)
@@ -219,6 +219,7 @@ void P_ChangeSwitchTexture(line_t *line, byte useAgain)
 // P_UseSpecialLine
 // Called when a thing uses a special line.
 // Only the front sides of lines are usable.
+// The sounds of new specials go in S_MarkLineSfx.
 //
 byte P_UseSpecialLine(mobj_t *thing, line_t *line, int side)
 {
@@ -21,6 +21,7 @@
 #include "p_local.h"
 #include "options.h"
 #include "doomstat.h"
+#include "i_cpu.h"
 
 int leveltime;
 
@@ -35,12 +36,58 @@ int leveltime;
 // Both the head and tail of the thinker list.
 thinker_t thinkercap;
 
+// Mobjs spawned with a state that never expires (tics == -1).
+// They are kept apart so P_RunThinkers doesn't have to walk them.
+thinker_t staticthinkercap;
+
+int numstaticthinkers;
+int numrunthinkers;
+int numdormantthinkers;
+
+unsigned int playerthinktime;
+unsigned int runthinkerstime;
+unsigned int updatespecialstime;
+
 //
 // P_InitThinkers
 //
 void P_InitThinkers(void)
 {
     thinkercap.prev = thinkercap.next = &thinkercap;
+    staticthinkercap.prev = staticthinkercap.next = &staticthinkercap;
+    numstaticthinkers = 0;
+}
+
+//
+// P_AddStaticThinker
+// Links a tickless mobj into the static list
+//
+void P_AddStaticThinker(thinker_t *thinker)
+{
+    staticthinkercap.prev->next = thinker;
+    thinker->next = &staticthinkercap;
+    thinker->prev = staticthinkercap.prev;
+    staticthinkercap.prev = thinker;
+
+    numstaticthinkers++;
+}
+
+//
+// P_ActivateStaticThinker
+// Moves a thinker from the static list to the end of the
+// main list, so it gets processed (or freed) by P_RunThinkers
+//
+void P_ActivateStaticThinker(thinker_t *thinker)
+{
+    thinker->next->prev = thinker->prev;
+    thinker->prev->next = thinker->next;
+
+    thinkercap.prev->next = thinker;
+    thinker->next = &thinkercap;
+    thinker->prev = thinkercap.prev;
+    thinkercap.prev = thinker;
+
+    numstaticthinkers--;
 }
 
 //
@@ -49,6 +96,8 @@ void P_InitThinkers(void)
 void P_RunThinkers(void)
 {
     thinker_t *currentthinker;
+    int run = 0;
+    int dormant = 0;
 
     currentthinker = thinkercap.next;
     while (currentthinker != &thinkercap)
@@ -62,16 +111,61 @@ void P_RunThinkers(void)
             currentthinker = currentthinker->next;
             continue;
         }
-        else if (currentthinker->function.acp1 == 0 || currentthinker->function.acp1 == (actionf_p1)P_MobjTicklessThinker)
+        else if (currentthinker->function.acp1 == 0)
         {
+            dormant++;
             currentthinker = currentthinker->next;
             continue;
         }
 
         currentthinker->function.acp1(currentthinker);
+        run++;
 
         currentthinker = currentthinker->next;
     }
+
+    numrunthinkers = run;
+    numdormantthinkers = dormant;
+}
+
+//
+// P_ResetPlaysimProfile
+//
+void P_ResetPlaysimProfile(void)
+{
+    playerthinktime = 0;
+    runthinkerstime = 0;
+    updatespecialstime = 0;
+
+    sightchecks = 0;
+    sightrejects = 0;
+    sightwalks = 0;
+    sightcachehits = 0;
+}
+
+//
+// P_TickerProfiled
+// Same as P_Ticker, timing each subsystem
+//
+static void P_TickerProfiled(void)
+{
+    unsigned int start;
+    unsigned int end;
+
+    start = I_ReadProfileClock();
+    P_PlayerThink();
+    end = I_ReadProfileClock();
+    playerthinktime += end - start;
+
+    start = end;
+    P_RunThinkers();
+    end = I_ReadProfileClock();
+    runthinkerstime += end - start;
+
+    start = end;
+    P_UpdateSpecials();
+    end = I_ReadProfileClock();
+    updatespecialstime += end - start;
 }
 
 //
@@ -86,10 +180,19 @@ void P_Ticker(void)
     if (paused || (menuactive && !demoplayback && players.viewz != 1))
         return;
 
-    P_PlayerThink();
+    P_FlushSightCache();
 
-    P_RunThinkers();
-    P_UpdateSpecials();
+    if (profiling)
+    {
+        P_TickerProfiled();
+    }
+    else
+    {
+        P_PlayerThink();
+
+        P_RunThinkers();
+        P_UpdateSpecials();
+    }
 
     // for par times
     leveltime++;
@@ -16,6 +16,7 @@
 //	BSP traversal, handling of LineSegs for rendering.
 //
 
+#include <stdio.h>
 #include <string.h>
 #include "options.h"
 #include "doomdef.h"
@@ -23,6 +24,8 @@
 #include "m_misc.h"
 
 #include "i_system.h"
+#include "w_wad.h"
+#include "z_zone.h"
 
 #include "r_main.h"
 #include "r_plane.h"
@@ -76,6 +79,13 @@ typedef struct
 cliprange_t *newend;
 cliprange_t solidsegs[MAXSEGS];
 
+// Solid walls cover the whole view width
+boolean viewclosed;
+
+// Traversal counters for the -stats overlay
+int bspnodesvisited;
+int bspsubsectorsvisited;
+
 //
 // R_ClipSolidWallSegment
 // Does handle solid walls,
@@ -161,6 +171,10 @@ crunch:
     }
 
     newend = start + 1;
+
+    // The first post covers every column
+    if (solidsegs[0].first < 0 && solidsegs[0].last >= viewwidth - 1)
+        viewclosed = true;
 }
 
 void R_UpdateClipSolidWallSegment(int first,
@@ -353,6 +367,7 @@ void R_ClearClipSegs(void)
     solidsegs[1].first = viewwidth;
     solidsegs[1].last = 0x7fffffff;
     newend = solidsegs + 2;
+    viewclosed = false;
 }
 
 //
@@ -360,7 +375,7 @@ void R_ClearClipSegs(void)
 // Clips the given segment
 // and adds any visible pieces to the line list.
 //
-void R_AddLine(seg_t *line)
+void R_AddLine(int num)
 {
     int x1;
     int x2;
@@ -368,12 +383,13 @@ void R_AddLine(seg_t *line)
     angle_t angle2;
     angle_t span;
     angle_t tspan;
+    renderseg_t *line;
 
-    curline = line;
+    line = &rendersegs[num];
 
     // OPTIMIZE: quickly reject orthogonal back sides.
-    angle1 = R_PointToAngle(line->v1->x, line->v1->y);
-    angle2 = R_PointToAngle(line->v2->x, line->v2->y);
+    angle1 = R_PointToAngle(vertexes[line->v1].x, vertexes[line->v1].y);
+    angle2 = R_PointToAngle(vertexes[line->v2].x, vertexes[line->v2].y);
 
     // Clip to view edges.
     // OPTIMIZE: make constant out of 2*clipangle (FIELDOFVIEW).
@@ -421,7 +437,8 @@ void R_AddLine(seg_t *line)
     if (x1 == x2)
         return;
 
-    backsector = line->backsector;
+    curline = &segs[num];
+    backsector = curline->backsector;
 
     // Single sided line?
     if (!backsector)
@@ -453,7 +470,7 @@ clipsolid:
     R_ClipSolidWallSegment(x1, x2 - 1);
 }
 
-void R_UpdateAddLine(seg_t *line)
+void R_UpdateAddLine(int num)
 {
     int x1;
     int x2;
@@ -461,12 +478,13 @@ void R_UpdateAddLine(seg_t *line)
     angle_t angle2;
     angle_t span;
     angle_t tspan;
+    renderseg_t *line;
 
-    curline = line;
+    line = &rendersegs[num];
 
     // OPTIMIZE: quickly reject orthogonal back sides.
-    angle1 = R_PointToAngle(line->v1->x, line->v1->y);
-    angle2 = R_PointToAngle(line->v2->x, line->v2->y);
+    angle1 = R_PointToAngle(vertexes[line->v1].x, vertexes[line->v1].y);
+    angle2 = R_PointToAngle(vertexes[line->v2].x, vertexes[line->v2].y);
 
     // Clip to view edges.
     // OPTIMIZE: make constant out of 2*clipangle (FIELDOFVIEW).
@@ -513,7 +531,8 @@ void R_UpdateAddLine(seg_t *line)
     if (x1 == x2)
         return;
 
-    backsector = line->backsector;
+    curline = &segs[num];
+    backsector = curline->backsector;
 
     // Single sided line?
     if (!backsector)
@@ -564,7 +583,7 @@ const int checkcoord[9][4] = {
     {BOXLEFT, BOXBOTTOM, BOXRIGHT, BOXTOP}     /* Below,Right */
 };
 
-byte R_CheckBBox(fixed_t *bspcoord)
+byte R_CheckBBox(short *bspcoord)
 {
     int *boxptr;
 
@@ -580,9 +599,9 @@ byte R_CheckBBox(fixed_t *bspcoord)
 
     // Find the corners of the box
     // that define the edges from current viewpoint.
-    if (viewy < bspcoord[BOXTOP])
+    if (viewy < (bspcoord[BOXTOP] << FRACBITS))
     {
-        if (viewy <= bspcoord[BOXBOTTOM])
+        if (viewy <= (bspcoord[BOXBOTTOM] << FRACBITS))
             boxptr = (&checkcoord[0][0]) + 24;
         else
             boxptr = (&checkcoord[0][0]) + 12;
@@ -592,9 +611,9 @@ byte R_CheckBBox(fixed_t *bspcoord)
         boxptr = (&checkcoord[0][0]);
     }
 
-    if (viewx > bspcoord[BOXLEFT])
+    if (viewx > (bspcoord[BOXLEFT] << FRACBITS))
     {
-        if (viewx >= bspcoord[BOXRIGHT])
+        if (viewx >= (bspcoord[BOXRIGHT] << FRACBITS))
             boxptr += 8;
         else
             boxptr += 4;
@@ -604,8 +623,8 @@ byte R_CheckBBox(fixed_t *bspcoord)
         return 1;
 
     // check clip list for an open space
-    angle1 = R_PointToAngle(bspcoord[boxptr[0]], bspcoord[boxptr[1]]) - viewangle;
-    angle2 = R_PointToAngle(bspcoord[boxptr[2]], bspcoord[boxptr[3]]) - viewangle;
+    angle1 = R_PointToAngle(bspcoord[boxptr[0]] << FRACBITS, bspcoord[boxptr[1]] << FRACBITS) - viewangle;
+    angle2 = R_PointToAngle(bspcoord[boxptr[2]] << FRACBITS, bspcoord[boxptr[3]] << FRACBITS) - viewangle;
 
     span = angle1 - angle2;
 
@@ -673,9 +692,11 @@ byte R_CheckBBox(fixed_t *bspcoord)
 void R_Subsector(int num)
 {
     int count;
-    seg_t *line;
+    int line;
     subsector_t *sub;
 
+    bspsubsectorsvisited++;
+
     sub = &subsectors[num];
     frontsector = sub->sector;
 
@@ -687,7 +708,7 @@ void R_Subsector(int num)
 
     R_AddSprites(frontsector);
 
-    line = &segs[sub->firstline];
+    line = sub->firstline;
     count = line + sub->numlines;
 
     while (line < count)
@@ -700,13 +721,13 @@ void R_Subsector(int num)
 void R_UpdateSubsector(int num)
 {
     int count;
-    seg_t *line;
+    int line;
     subsector_t *sub;
 
     sub = &subsectors[num];
     frontsector = sub->sector;
 
-    line = &segs[sub->firstline];
+    line = sub->firstline;
     count = line + sub->numlines;
 
     while (line < count)
@@ -716,6 +737,231 @@ void R_UpdateSubsector(int num)
     }
 }
 
+//
+// R_LoadRenderBSP
+// Packs the nodes and segs of the level for the traversal.
+//
+rendernode_t *rendernodes;
+renderseg_t *rendersegs;
+
+void R_LoadRenderBSP(void)
+{
+    int i;
+    int j;
+    int k;
+    node_t *no;
+    rendernode_t *rn;
+
+    rendernodes = Z_MallocUnowned((firstnode + 1) * sizeof(rendernode_t), PU_LEVEL);
+    rendersegs = Z_MallocUnowned(numsegs * sizeof(renderseg_t), PU_LEVEL);
+
+    no = nodes;
+    rn = rendernodes;
+
+    for (i = 0; i <= firstnode; i++, no++, rn++)
+    {
+        rn->x = no->xs;
+        rn->y = no->ys;
+        rn->dx = no->dxs;
+        rn->dy = no->dys;
+
+        for (j = 0; j < 2; j++)
+        {
+            rn->children[j] = no->children[j];
+            for (k = 0; k < 4; k++)
+                rn->bbox[j][k] = no->bbox[j][k] >> FRACBITS;
+        }
+    }
+
+    for (i = 0; i < numsegs; i++)
+    {
+        rendersegs[i].v1 = segs[i].v1 - vertexes;
+        rendersegs[i].v2 = segs[i].v2 - vertexes;
+    }
+}
+
+//
+// Potentially visible set.
+// Built offline by SCRIPTS/PVS/fastdoom_pvs.py and stored in a
+// PVSExMy / PVSMAPxx lump: the subsector count, the offset of each
+// row, then a row per subsector with a bit for every subsector that
+// can be seen from it. Zero bytes of a row are stored as a 0
+// followed by a count.
+//
+boolean pvsactive;
+
+static int *pvsdata;
+static byte *pvsrow;   // Subsectors seen from pvsviewer
+static byte *pvsnodes; // Nodes with a subsector seen from pvsviewer
+static int pvsviewer;
+
+#define PVS_VISIBLE(bits, num) ((bits)[(num) >> 3] & (1 << ((num)&7)))
+
+// Node child, either a subsector or a node
+#define PVS_CHILD_VISIBLE(child) ((child)&NF_SUBSECTOR ? PVS_VISIBLE(pvsrow, (child) & (~NF_SUBSECTOR)) : PVS_VISIBLE(pvsnodes, child))
+
+//
+// R_CheckPVSRow
+// Returns whether a packed row unpacks within the lump.
+//
+static boolean R_CheckPVSRow(byte *src, byte *lumpend)
+{
+    int rowbytes;
+    int i;
+
+    rowbytes = (numsubsectors + 7) >> 3;
+
+    while (rowbytes > 0)
+    {
+        if (src >= lumpend)
+            return false;
+
+        if (*src)
+        {
+            src++;
+            rowbytes--;
+        }
+        else
+        {
+            if (src + 1 >= lumpend)
+                return false;
+
+            i = src[1];
+            src += 2;
+
+            if (i == 0)
+                return false;
+
+            rowbytes -= i;
+        }
+    }
+
+    return true;
+}
+
+//
+// R_LoadPVS
+// Called after the nodes are loaded.
+//
+void R_LoadPVS(char *mapname)
+{
+    char lumpname[9];
+    int lump;
+    int length;
+    int header;
+    int i;
+    int j;
+
+    pvsactive = false;
+    pvsviewer = -1;
+
+    if (noPVS || firstnode < 0)
+        return;
+
+    sprintf(lumpname, "PVS%s", mapname);
+    lump = W_GetNumForName(lumpname);
+
+    if (lump == -1)
+        return;
+
+    length = W_LumpLength(lump);
+    header = (numsubsectors + 1) * sizeof(int);
+
+    if (length < header)
+        return;
+
+    pvsdata = W_CacheLumpNum(lump, PU_LEVEL);
+
+    // Built for another version of the map
+    if (pvsdata[0] != numsubsectors)
+        return;
+
+    // Truncated or foreign lumps
+    for (i = 0; i < numsubsectors; i++)
+    {
+        if (pvsdata[1 + i] < header || pvsdata[1 + i] >= length)
+            return;
+
+        if (!R_CheckPVSRow((byte *)pvsdata + pvsdata[1 + i], (byte *)pvsdata + length))
+            return;
+    }
+
+    // The node bits are found in a single pass, children first
+    for (i = 0; i <= firstnode; i++)
+    {
+        for (j = 0; j < 2; j++)
+        {
+            if (!(rendernodes[i].children[j] & NF_SUBSECTOR) && rendernodes[i].children[j] >= i)
+                return;
+        }
+    }
+
+    pvsrow = Z_MallocUnowned((numsubsectors + 7) >> 3, PU_LEVEL);
+    pvsnodes = Z_MallocUnowned((firstnode + 8) >> 3, PU_LEVEL);
+    pvsactive = true;
+}
+
+//
+// R_SetupPVS
+// Unpacks the visibility of the subsector holding the view point.
+//
+void R_SetupPVS(void)
+{
+    int viewer;
+    int i;
+    int j;
+    int child;
+    byte *src;
+    byte *dest;
+    byte *end;
+
+    viewer = R_PointInSubsector(viewx, viewy) - subsectors;
+
+    if (viewer == pvsviewer)
+        return;
+
+    pvsviewer = viewer;
+
+    src = (byte *)pvsdata + pvsdata[1 + viewer];
+    dest = pvsrow;
+    end = pvsrow + ((numsubsectors + 7) >> 3);
+
+    while (dest < end)
+    {
+        if (*src)
+        {
+            *dest++ = *src++;
+        }
+        else
+        {
+            i = src[1];
+            src += 2;
+
+            if (i > end - dest)
+                i = end - dest;
+
+            memset(dest, 0, i);
+            dest += i;
+        }
+    }
+
+    memset(pvsnodes, 0, (firstnode + 8) >> 3);
+
+    for (i = 0; i <= firstnode; i++)
+    {
+        for (j = 0; j < 2; j++)
+        {
+            child = rendernodes[i].children[j];
+
+            if (PVS_CHILD_VISIBLE(child))
+            {
+                pvsnodes[i >> 3] |= 1 << (i & 7);
+                break;
+            }
+        }
+    }
+}
+
 //
 // RenderBSPNode
 // Renders all subsectors below a given node,
@@ -726,11 +972,14 @@ void R_UpdateSubsector(int num)
 
 void R_RenderBSPNode(int bspnum)
 {
-    node_t *bsp;
+    rendernode_t *bsp;
     int stack_bsp[MAX_BSP_DEPTH];
     byte stack_side[MAX_BSP_DEPTH];
     byte sp = 0;
 
+    bspnodesvisited = 0;
+    bspsubsectorsvisited = 0;
+
     while (true)
     {
         // Front sides.
@@ -742,21 +991,27 @@ void R_RenderBSPNode(int bspnum)
             if (sp == MAX_BSP_DEPTH)
                 break;
 
-            bsp = &nodes[bspnum];
+            // Nothing below can be seen from the view point
+            if (pvsactive && !PVS_VISIBLE(pvsnodes, bspnum))
+                break;
+
+            bspnodesvisited++;
+
+            bsp = &rendernodes[bspnum];
 
             // decide which side the view point is on
-            dx = (viewxs - bsp->xs);
-            dy = (viewys - bsp->ys);
+            dx = (viewxs - bsp->x);
+            dy = (viewys - bsp->y);
 
             // Try to quickly decide by looking at sign bits.
-            if ((bsp->dys ^ bsp->dxs ^ dx ^ dy) & 0x80000000)
+            if ((bsp->dy ^ bsp->dx ^ dx ^ dy) & 0x80000000)
             {
-                side = ROLAND1(bsp->dys ^ dx);
+                side = ROLAND1(bsp->dy ^ dx);
             }
             else
             {
-                fixed_t left = (bsp->dys) * (dx);
-                fixed_t right = (dy) * (bsp->dxs);
+                fixed_t left = (bsp->dy) * (dx);
+                fixed_t right = (dy) * (bsp->dx);
 
                 side = right >= left;
             }
@@ -771,10 +1026,14 @@ void R_RenderBSPNode(int bspnum)
 
         if (bspnum == -1)
             R_Subsector(0);
-        else
+        else if (!pvsactive)
+            R_Subsector(bspnum & (~NF_SUBSECTOR));
+        else if ((bspnum & NF_SUBSECTOR) && PVS_VISIBLE(pvsrow, bspnum & (~NF_SUBSECTOR)))
             R_Subsector(bspnum & (~NF_SUBSECTOR));
 
-        if (sp == 0)
+        // Every column is behind a solid wall, the back
+        // sides left in the stack can't be visible.
+        if (sp == 0 || viewclosed)
         {
             // back at root node and not visible. All done!
             return;
@@ -784,12 +1043,13 @@ void R_RenderBSPNode(int bspnum)
 
         sp--;
 
-        bsp = &nodes[stack_bsp[sp]];
+        bsp = &rendernodes[stack_bsp[sp]];
 
         // Possibly divide back space.
         // Walk back up the tree until we find
         // a node that has a visible backspace.
-        while (!R_CheckBBox(bsp->bbox[stack_side[sp]]))
+        // Subtrees out of the PVS are skipped before the bbox test.
+        while ((pvsactive && !PVS_CHILD_VISIBLE(bsp->children[stack_side[sp]])) || !R_CheckBBox(bsp->bbox[stack_side[sp]]))
         {
             if (sp == 0)
             {
@@ -801,7 +1061,7 @@ void R_RenderBSPNode(int bspnum)
 
             sp--;
 
-            bsp = &nodes[stack_bsp[sp]];
+            bsp = &rendernodes[stack_bsp[sp]];
         }
 
         bspnum = bsp->children[stack_side[sp]];
@@ -810,7 +1070,7 @@ void R_RenderBSPNode(int bspnum)
 
 void R_UpdateBSPNode(int bspnum)
 {
-    node_t *bsp;
+    rendernode_t *bsp;
     int stack_bsp[MAX_BSP_DEPTH];
     byte stack_side[MAX_BSP_DEPTH];
     byte sp = 0;
@@ -826,21 +1086,21 @@ void R_UpdateBSPNode(int bspnum)
             if (sp == MAX_BSP_DEPTH)
                 break;
 
-            bsp = &nodes[bspnum];
+            bsp = &rendernodes[bspnum];
 
             // decide which side the view point is on
-            dx = (viewxs - bsp->xs);
-            dy = (viewys - bsp->ys);
+            dx = (viewxs - bsp->x);
+            dy = (viewys - bsp->y);
 
             // Try to quickly decide by looking at sign bits.
-            if ((bsp->dys ^ bsp->dxs ^ dx ^ dy) & 0x80000000)
+            if ((bsp->dy ^ bsp->dx ^ dx ^ dy) & 0x80000000)
             {
-                side = ROLAND1(bsp->dys ^ dx);
+                side = ROLAND1(bsp->dy ^ dx);
             }
             else
             {
-                fixed_t left = (bsp->dys) * (dx);
-                fixed_t right = (dy) * (bsp->dxs);
+                fixed_t left = (bsp->dy) * (dx);
+                fixed_t right = (dy) * (bsp->dx);
 
                 side = right >= left;
             }
@@ -868,7 +1128,7 @@ void R_UpdateBSPNode(int bspnum)
 
         sp--;
 
-        bsp = &nodes[stack_bsp[sp]];
+        bsp = &rendernodes[stack_bsp[sp]];
 
         // Possibly divide back space.
         // Walk back up the tree until we find
@@ -885,7 +1145,7 @@ void R_UpdateBSPNode(int bspnum)
 
             sp--;
 
-            bsp = &nodes[stack_bsp[sp]];
+            bsp = &rendernodes[stack_bsp[sp]];
         }
 
         bspnum = bsp->children[stack_side[sp]];
@@ -34,7 +34,20 @@ typedef void (*drawfunc_t)(int start, int stop);
 void R_ClearClipSegs(void);
 void R_ClearDrawSegs(void);
 
+void R_LoadRenderBSP(void);
+
 void R_RenderBSPNode(int bspnum);
 void R_UpdateBSPNode(int bspnum);
 
+extern boolean viewclosed;
+
+extern int bspnodesvisited;
+extern int bspsubsectorsvisited;
+
+// Potentially visible set of the current map
+extern boolean pvsactive;
+
+void R_LoadPVS(char *mapname);
+void R_SetupPVS(void);
+
 #endif
@@ -31,6 +31,7 @@
 #include "p_local.h"
 #include "doomstat.h"
 #include "r_data.h"
+#include "s_sound.h"
 
 //
 // Graphics.
@@ -126,6 +127,8 @@ int *texturecompositesize;
 short **texturecolumnlump;
 unsigned short **texturecolumnofs;
 byte **texturecomposite;
+byte **texturemipmaps[MIPLEVELS];
+byte **flatmipmaps[MIPLEVELS];
 
 // for global animation
 int *flattranslation;
@@ -133,6 +136,7 @@ int *texturetranslation;
 
 // needed for pre rendering
 fixed_t *spritewidth;
+spritepatch_t **spritepatches;
 fixed_t *spriteoffset;
 fixed_t *spritetopoffset;
 
@@ -253,6 +257,78 @@ void R_GenerateComposite(int texnum)
     Z_ChangeTag(block, PU_CACHE);
 }
 
+//
+// R_GenerateMipmap
+// Point samples every 2^level texel of the texture.
+// The columns keep the 128 texel stride the column
+// drawers wrap at, so they are repeated to fill it.
+//
+void R_GenerateMipmap(int texnum, int level)
+{
+    byte *block;
+    byte *source;
+    byte *dest;
+    int width;
+    int x;
+    int y;
+    int col;
+    int lump;
+
+    width = (texturewidthmask[texnum] >> level) + 1;
+
+    block = Z_Malloc(width * 128, PU_STATIC, &texturemipmaps[level][texnum]);
+
+    for (x = 0, dest = block; x < width; x++, dest += 128)
+    {
+        col = (x << level) & texturewidthmask[texnum];
+        lump = texturecolumnlump[texnum][col];
+
+        if (lump > 0)
+        {
+            source = (byte *)W_CacheLumpNum(lump, PU_CACHE) + texturecolumnofs[texnum][col];
+        }
+        else
+        {
+            if (!texturecomposite[texnum])
+                R_GenerateComposite(texnum);
+
+            source = texturecomposite[texnum] + texturecolumnofs[texnum][col];
+        }
+
+        for (y = 0; y < 128; y++)
+            dest[y] = source[(y << level) & 127];
+    }
+
+    Z_ChangeTag(block, PU_CACHE);
+}
+
+//
+// R_GenerateFlatMipmap
+// Point samples every 2^level texel of the flat.
+// The span drawers address 64x64 texels, so the smaller
+// flat is tiled to fill them.
+//
+void R_GenerateFlatMipmap(int flatnum, int level)
+{
+    byte *block;
+    byte *source;
+    byte *dest;
+    int x;
+    int y;
+
+    block = Z_Malloc(64 * 64, PU_STATIC, &flatmipmaps[level][flatnum]);
+
+    source = W_CacheLumpNum(firstflat + flatnum, PU_CACHE);
+
+    for (y = 0, dest = block; y < 64; y++, dest += 64)
+    {
+        for (x = 0; x < 64; x++)
+            dest[x] = source[(((y << level) & 63) << 6) + ((x << level) & 63)];
+    }
+
+    Z_ChangeTag(block, PU_CACHE);
+}
+
 //
 // R_GenerateLookup
 //
@@ -448,6 +524,13 @@ void R_InitTextures(void)
     texturecolumnofs = Z_MallocUnowned(numtextures * 4, PU_STATIC);
     texturecomposite = Z_MallocUnowned(numtextures * 4, PU_STATIC);
     texturecompositesize = Z_MallocUnowned(numtextures * 4, PU_STATIC);
+
+    for (i = 1; i < MIPLEVELS; i++)
+    {
+        texturemipmaps[i] = Z_MallocUnowned(numtextures * 4, PU_STATIC);
+        memset(texturemipmaps[i], 0, numtextures * 4);
+    }
+
     texturewidthmask = Z_MallocUnowned(numtextures * 4, PU_STATIC);
     textureheight = Z_MallocUnowned(numtextures * 4, PU_STATIC);
 
@@ -548,6 +631,12 @@ void R_InitFlats(void)
 
     for (i = 0; i < numflats; i++)
         flattranslation[i] = i;
+
+    for (i = 1; i < MIPLEVELS; i++)
+    {
+        flatmipmaps[i] = Z_MallocUnowned(numflats * 4, PU_STATIC);
+        memset(flatmipmaps[i], 0, numflats * 4);
+    }
 }
 
 //
@@ -568,6 +657,8 @@ void R_InitSpriteLumps(void)
     spritewidth = Z_MallocUnowned(numspritelumps * 4, PU_STATIC);
     spriteoffset = Z_MallocUnowned(numspritelumps * 4, PU_STATIC);
     spritetopoffset = Z_MallocUnowned(numspritelumps * 4, PU_STATIC);
+    spritepatches = Z_MallocUnowned(numspritelumps * 4, PU_STATIC);
+    memset(spritepatches, 0, numspritelumps * 4);
 
     for (i = 0; i < numspritelumps; i++)
     {
@@ -581,6 +672,89 @@ void R_InitSpriteLumps(void)
     }
 }
 
+//
+// R_DecodeSprite
+// Converts the posts of a sprite lump into spritepost_t runs.
+// Every post keeps its pad bytes and starts on a dword boundary,
+// the texels follow the leading pad byte.
+//
+void R_DecodeSprite(int num)
+{
+    patch_t *patch;
+    column_t *column;
+    spritepatch_t *sprite;
+    spritepost_t *post;
+    byte *texels;
+    int numposts;
+    int size;
+    int x;
+
+    patch = W_CacheLumpNum(firstspritelump + num, PU_CACHE);
+
+    numposts = 0;
+    size = 0;
+
+    for (x = 0; x < patch->width; x++)
+    {
+        column = (column_t *)((byte *)patch + patch->columnofs[x]);
+
+        for (; column->topdelta != 0xff; column = (column_t *)((byte *)column + column->length + 4))
+        {
+            if (!column->length)
+                continue;
+
+            numposts++;
+            size += (column->length + 2 + 3) & ~3;
+        }
+
+        // End of column
+        numposts++;
+    }
+
+    x = sizeof(spritepatch_t) + (patch->width - 1) * sizeof(int);
+    size += x + numposts * sizeof(spritepost_t);
+
+    sprite = Z_Malloc(size, PU_STATIC, &spritepatches[num]);
+
+    // The lump may have been purged
+    patch = W_CacheLumpNum(firstspritelump + num, PU_CACHE);
+
+    post = (spritepost_t *)((byte *)sprite + x);
+    texels = (byte *)(post + numposts);
+
+    sprite->width = patch->width;
+
+    for (x = 0; x < patch->width; x++)
+    {
+        sprite->columnofs[x] = (byte *)post - (byte *)sprite;
+        column = (column_t *)((byte *)patch + patch->columnofs[x]);
+
+        for (; column->topdelta != 0xff; column = (column_t *)((byte *)column + column->length + 4))
+        {
+            if (!column->length)
+                continue;
+
+            post->topdelta = column->topdelta;
+            post->length = column->length;
+            post->ofs = texels + 1 - (byte *)sprite;
+            post++;
+
+            // Pad bytes included, the alignment tail repeats the last one
+            size = column->length + 2;
+            CopyBytes((byte *)column + 2, texels, size);
+            SetBytes(texels + size, texels[size - 1], ((size + 3) & ~3) - size);
+            texels += (size + 3) & ~3;
+        }
+
+        post->topdelta = 0;
+        post->length = 0;
+        post->ofs = 0;
+        post++;
+    }
+
+    Z_ChangeTag(sprite, PU_CACHE);
+}
+
 //
 // R_InitColormaps
 //
@@ -861,6 +1035,12 @@ void R_PrecacheLevel(void)
             lump = firstflat + i;
             flatmemory += lumpinfo[lump].size;
             W_CacheLumpNum(lump, PU_CACHE);
+
+            if (lodSpan)
+            {
+                for (j = 1; j < MIPLEVELS; j++)
+                    R_GenerateFlatMipmap(i, j);
+            }
         }
     }
 
@@ -891,6 +1071,12 @@ void R_PrecacheLevel(void)
         // [crispy] precache composite textures
         R_GenerateComposite(i);
 
+        if (mipmapWalls)
+        {
+            for (j = 1; j < MIPLEVELS; j++)
+                R_GenerateMipmap(i, j);
+        }
+
         texture = textures[i];
 
         for (j = 0; j < texture->patchcount; j++)
@@ -909,6 +1095,10 @@ void R_PrecacheLevel(void)
             spritepresent[((mobj_t *)th)->sprite] = 1;
     }
 
+    // Tickless decorations live on their own list
+    for (th = staticthinkercap.next; th != &staticthinkercap; th = th->next)
+        spritepresent[((mobj_t *)th)->sprite] = 1;
+
     for (i = 0; i < NUMSPRITES; i++)
     {
         if (!spritepresent[i])
@@ -918,13 +1108,13 @@ void R_PrecacheLevel(void)
         {
             sf = &sprites[i].spriteframes[j];
             for (k = 0; k < 8; k++)
-            {
-                lump = firstspritelump + sf->lump[k];
-                W_CacheLumpNum(lump, PU_CACHE);
-            }
+                R_CacheSprite(sf->lump[k]);
         }
     }
 
     Z_Free(flatpresent);
     Z_Free(texturepresent);
+
+    // Precache sounds.
+    S_PrecacheLevel();
 }
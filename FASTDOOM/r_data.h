@@ -25,6 +25,14 @@
 
 // Retrieve column data for span blitting.
 void R_GenerateComposite(int texnum);
+void R_GenerateMipmap(int texnum, int level);
+void R_GenerateFlatMipmap(int flatnum, int level);
+void R_DecodeSprite(int num);
+
+// Sprite lumps in spritepost_t runs, purgable
+extern spritepatch_t **spritepatches;
+
+#define R_CacheSprite(num) (spritepatches[num] ? spritepatches[num] : (R_DecodeSprite(num), spritepatches[num]))
 
 // I/O, setting up the stuff.
 void R_InitData(void);
@@ -46,7 +54,20 @@ extern int *texturewidthmask;
 extern short **texturecolumnlump;
 extern unsigned short **texturecolumnofs;
 extern byte **texturecomposite;
+extern short numtextures;
+
+// Half and quarter resolution textures and flats, level 0 is unused
+#define MIPLEVELS 3
+
+// Walls at a scale below these use mip level 1 and 2
+#define MIPSCALE1 (FRACUNIT / 2)
+#define MIPSCALE2 (FRACUNIT / 4)
+
+extern byte **texturemipmaps[MIPLEVELS];
+extern byte **flatmipmaps[MIPLEVELS];
 
 extern byte *tintmap;
 
+extern int flatmemory;
+
 #endif
@@ -273,6 +273,38 @@ typedef struct
 
 } node_t;
 
+//
+// Renderer copy of a BSP node.
+// Map units only, so the traversal touches a quarter
+// of the memory of node_t.
+//
+typedef struct
+{
+    // Partition line.
+    short x;
+    short y;
+    short dx;
+    short dy;
+
+    // Bounding box for each child.
+    short bbox[2][4];
+
+    // If NF_SUBSECTOR its a subsector.
+    unsigned short children[2];
+
+} rendernode_t;
+
+//
+// Renderer copy of a seg, enough to reject it
+// without touching seg_t.
+//
+typedef struct
+{
+    unsigned short v1;
+    unsigned short v2;
+
+} renderseg_t;
+
 // posts are runs of non masked source pixels
 typedef struct
 {
@@ -349,6 +381,21 @@ typedef struct
     // the [0] is &columnofs[width]
 } patch_t;
 
+// Sprite posts decoded for drawing, see R_CacheSprite
+typedef struct
+{
+    short topdelta;
+    short length; // 0 is the last post in a column
+    int ofs;      // texels, from the start of the sprite
+} spritepost_t;
+
+typedef struct
+{
+    int width;
+    int columnofs[1]; // first spritepost_t of each column,
+                      // from the start of the sprite
+} spritepatch_t;
+
 // A vissprite_t is a thing
 //  that will be drawn during a refresh.
 // I.e. a sprite object that is partly visible.
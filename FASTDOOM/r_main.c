@@ -28,6 +28,7 @@
 #include "d_net.h"
 #include "i_debug.h"
 #include "m_misc.h"
+#include "i_cpu.h"
 
 #include "r_local.h"
 
@@ -831,7 +832,7 @@ void R_InitLightTables(void)
 }
 
 //
-// R_SetViewSize
+// R_QueueViewSize
 // Do not really change anything here,
 //  because it might be in the middle of a refresh.
 // The change will take effect next refresh.
@@ -840,7 +841,7 @@ byte setsizeneeded;
 int setblocks;
 int setdetail;
 
-void R_SetViewSize(int blocks, int detail)
+static void R_QueueViewSize(int blocks, int detail)
 {
     setsizeneeded = 1;
     setblocks = blocks;
@@ -856,6 +857,109 @@ void R_SetViewSize(int blocks, int detail)
     }
 }
 
+//
+// R_GovernDetail
+// Lowers the detail, then the visplane quality, while the frames
+// take longer than 1/autoDetail seconds, and raises it back once
+// there is room. Both directions have to hold for a while so the
+// view does not flicker between two levels.
+//
+extern int detailLevel;
+
+#define GOVERNOR_SLOWFRAMES 16
+#define GOVERNOR_FASTTICKS (3 * 560)
+
+static int governorLevel; // Steps below the user settings
+static int governorAverage; // Frame time in 1/16 of the 560Hz timer
+static int governorFrames; // Slow frames in a row
+static int governorTicks; // Time spent on fast frames
+boolean governorFlatSpans;
+
+// Detail levels left below the user setting
+static int R_GovernorDetailSteps(void)
+{
+#if defined(MODE_X) || defined(MODE_Y) || defined(MODE_Y_HALF) || defined(USE_BACKBUFFER) || defined(MODE_VBE2_DIRECT)
+    if (!forcePotatoDetail && !forceLowDetail && !forceHighDetail)
+        return DETAIL_POTATO - detailLevel;
+#endif
+
+    return 0;
+}
+
+void R_GovernDetail(int frameticks)
+{
+    int target;
+    int steps;
+    int max;
+    int level;
+
+    if (gamestate != GS_LEVEL || setsizeneeded)
+        return;
+
+    // Frame time wanted, in the same units as the average
+    target = (560 * 16) / autoDetail;
+
+    if (governorAverage)
+        governorAverage += (frameticks * 16 - governorAverage) >> 3;
+    else
+        governorAverage = frameticks * 16;
+
+    level = governorLevel;
+    steps = R_GovernorDetailSteps();
+    max = steps + (visplaneRender == VISPLANES_NORMAL);
+
+    if (governorAverage > target + target / 8 && level < max)
+    {
+        governorTicks = 0;
+        if (++governorFrames >= GOVERNOR_SLOWFRAMES)
+            level++;
+    }
+    else if (governorAverage < target - target / 3 && level > 0)
+    {
+        // Fast frames come often, hold for a time instead of a count
+        governorFrames = 0;
+        governorTicks += frameticks;
+        if (governorTicks >= GOVERNOR_FASTTICKS)
+            level--;
+    }
+    else
+    {
+        governorFrames = 0;
+        governorTicks = 0;
+    }
+
+    // The menu may have changed the settings under the governor
+    if (level > max)
+        level = max;
+
+    if (level == governorLevel)
+        return;
+
+    governorLevel = level;
+    governorFrames = 0;
+    governorTicks = 0;
+    governorAverage = target;
+
+    governorFlatSpans = level > steps;
+
+    R_QueueViewSize(screenblocks, detailLevel + (governorFlatSpans ? steps : level));
+}
+
+//
+// R_SetViewSize
+// The user settings changed, the governor starts over from them
+//
+void R_SetViewSize(int blocks, int detail)
+{
+    governorLevel = 0;
+    governorFrames = 0;
+    governorTicks = 0;
+    governorAverage = 0;
+    governorFlatSpans = false;
+
+    R_QueueViewSize(blocks, detail);
+}
+
 void R_PatchCode(void)
 {
 #if defined(MODE_X) || defined(MODE_Y) || defined(MODE_Y_HALF)
@@ -912,29 +1016,31 @@ void R_ExecuteSetViewSize(void)
     int j;
     int level;
     int startmap;
+    int planeRender;
 
     setsizeneeded = 0;
 
-    // TODO Add more granular detection
+    planeRender = visplaneRender;
+
+    if (governorFlatSpans && planeRender == VISPLANES_NORMAL)
+        planeRender = VISPLANES_FLAT;
+
     if (selectedCPU == AUTO_CPU)
+        selectedCPU = I_GetDetectedCPU();
+
+    // MUL is much cheaper than DIV from the Pentium class on
+    switch (selectedCPU)
     {
-        switch (I_GetCPUModel())
-        {
-        case 386:
-            selectedCPU = INTEL_386SX;
-            break;
-        case 486:
-            selectedCPU = INTEL_486;
-            break;
-        case 586:
-        case 686:
-            selectedCPU = INTEL_PENTIUM;
-            break;
-        default:
-            selectedCPU = INTEL_386SX;
-            break;
-        }
+    case CYRIX_5X86:
+    case AMD_K5:
+    case INTEL_PENTIUM:
+        reciprocalScale = true;
+        break;
+    default:
+        reciprocalScale = false;
+        break;
     }
+
 #if !defined(MODE_T8050) && !defined(MODE_T8043) && !defined(MODE_T8025) && !defined(MODE_T4025) && !defined(MODE_T4050) && !defined(MODE_MDA)
     if (setblocks >= 11)
     {
@@ -1086,7 +1192,7 @@ void R_ExecuteSetViewSize(void)
         break;
     }
 
-    switch (visplaneRender)
+    switch (planeRender)
     {
     case VISPLANES_NORMAL:
         drawPlanes = R_DrawPlanes;
@@ -1172,7 +1278,7 @@ void R_ExecuteSetViewSize(void)
         break;
     }
 
-    switch (visplaneRender)
+    switch (planeRender)
     {
     case VISPLANES_NORMAL:
         drawPlanes = R_DrawPlanes;
@@ -1257,7 +1363,7 @@ void R_ExecuteSetViewSize(void)
         break;
     }
 
-    switch (visplaneRender)
+    switch (planeRender)
     {
     case VISPLANES_NORMAL:
         drawPlanes = R_DrawPlanes;
@@ -1357,7 +1463,7 @@ void R_ExecuteSetViewSize(void)
         break;
     }
 
-    switch (visplaneRender)
+    switch (planeRender)
     {
     case VISPLANES_NORMAL:
         drawPlanes = R_DrawPlanes;
@@ -1498,7 +1604,7 @@ void R_ExecuteSetViewSize(void)
             break;
         }
 
-        switch (visplaneRender)
+        switch (planeRender)
         {
         case VISPLANES_NORMAL:
             drawPlanes = R_DrawPlanes;
@@ -1664,7 +1770,7 @@ void R_ExecuteSetViewSize(void)
             break;
         }
 
-        switch (visplaneRender)
+        switch (planeRender)
         {
         case VISPLANES_NORMAL:
             drawPlanes = R_DrawPlanes;
@@ -1831,7 +1937,7 @@ void R_ExecuteSetViewSize(void)
             break;
         }
 
-        switch (visplaneRender)
+        switch (planeRender)
         {
         case VISPLANES_NORMAL:
             drawPlanes = R_DrawPlanes;
@@ -2002,7 +2108,7 @@ void R_ExecuteSetViewSize(void)
             break;
         }
 
-        switch (visplaneRender)
+        switch (planeRender)
         {
         case VISPLANES_NORMAL:
             drawPlanes = R_DrawPlanes;
@@ -2168,7 +2274,7 @@ void R_ExecuteSetViewSize(void)
             break;
         }
 
-        switch (visplaneRender)
+        switch (planeRender)
         {
         case VISPLANES_NORMAL:
             drawPlanes = R_DrawPlanes;
@@ -2294,7 +2400,7 @@ void R_ExecuteSetViewSize(void)
             break;
         }
 
-        switch (visplaneRender)
+        switch (planeRender)
         {
         case VISPLANES_NORMAL:
             drawPlanes = R_DrawPlanes;
@@ -2413,7 +2519,7 @@ void R_ExecuteSetViewSize(void)
             break;
         }
 
-        switch (visplaneRender)
+        switch (planeRender)
         {
         case VISPLANES_NORMAL:
             drawPlanes = R_DrawPlanes;
@@ -2525,7 +2631,7 @@ void R_ExecuteSetViewSize(void)
             break;
         }
 
-        switch (visplaneRender)
+        switch (planeRender)
         {
         case VISPLANES_NORMAL:
             drawPlanes = R_DrawPlanes;
@@ -2637,7 +2743,7 @@ void R_ExecuteSetViewSize(void)
             break;
         }
 
-        switch (visplaneRender)
+        switch (planeRender)
         {
         case VISPLANES_NORMAL:
             drawPlanes = R_DrawPlanes;
@@ -2803,13 +2909,12 @@ void R_ExecuteSetViewSize(void)
 //
 // R_Init
 //
-extern int detailLevel;
-
 #define SKYFLATNAME "F_SKY1"
 
 void R_Init(void)
 {
     R_InitData();
+    R_InitWallColumns();
     // viewwidth / viewheight / detailLevel are set by the defaults
     printf(".");
 
@@ -2944,8 +3049,12 @@ void R_RenderPlayerView(void)
     }
 #endif
 
+    if (pvsactive)
+        R_SetupPVS();
+
     // The head node is the last node output.
     R_RenderBSPNode(firstnode);
+    R_FlushWallColumns();
 
     // Check for new console commands.
     NetUpdate();
@@ -146,6 +146,10 @@ R_PointInSubsector(fixed_t x,
 
 void R_ExecuteSetViewSize(void);
 
+// Detail governor for -autodetail
+extern boolean governorFlatSpans;
+void R_GovernDetail(int frameticks);
+
 //
 // REFRESH - the actual rendering functions.
 //
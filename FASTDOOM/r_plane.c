@@ -90,6 +90,10 @@ fixed_t cacheddistance[SCREENHEIGHT];
 
 fixed_t cachedstep[SCREENHEIGHT];
 
+// Flat of the plane being drawn and its full resolution texels
+static int planeflat;
+static byte *planesource;
+
 //
 // R_MapPlane
 //
@@ -108,7 +112,10 @@ void R_MapPlane(int y)
     angle_t angle;
     fixed_t distance;
     fixed_t length;
+    fixed_t xfrac;
+    fixed_t yfrac;
     unsigned index;
+    int miplevel;
     int x1 = spanstart[y];
 #if defined(MODE_CGA16) || defined(MODE_CGA512) || defined(MODE_CGA_AFH)
     if (y & 1)
@@ -136,11 +143,6 @@ void R_MapPlane(int y)
         ds_step = cachedstep[y];
     }
 
-    angle = (viewangle + xtoviewangle[x1]) >> ANGLETOFINESHIFT;
-    length = FixedMul(distance, distscale[x1]);
-
-    ds_frac = (((viewx + FixedMul(finecosine[angle], length)) << 10) & 0xFFFF0000) | (((viewyneg - FixedMul(finesine[angle], length)) >> 6) & 0xFFFF);
-
     if (fixedcolormap)
         ds_colormap = fixedcolormap;
     else
@@ -155,6 +157,47 @@ void R_MapPlane(int y)
         }
     }
 
+    // pick a smaller flat for distant rows, at the same
+    // texel to pixel scales as the wall mip levels
+    miplevel = 0;
+
+    if (lodSpan)
+    {
+        if (distance >= projection << 2)
+            miplevel = 2;
+        else if (distance >= projection << 1)
+            miplevel = 1;
+
+        if (miplevel)
+        {
+            if (!flatmipmaps[miplevel][planeflat])
+            {
+                R_GenerateFlatMipmap(planeflat, miplevel);
+
+                // The flat lump may have been purged
+                planesource = W_CacheLumpNum(firstflat + planeflat, PU_CACHE);
+            }
+
+            ds_source = flatmipmaps[miplevel][planeflat];
+
+            // Shift x and y apart so x does not spill into y. Their
+            // wrap at 64 texels lands on a repeat of the tiled flat
+            ds_step = ((ds_step >> miplevel) & 0xFFFF0000) | ((ds_step & 0xFFFF) >> miplevel);
+        }
+        else
+        {
+            ds_source = planesource;
+        }
+    }
+
+    angle = (viewangle + xtoviewangle[x1]) >> ANGLETOFINESHIFT;
+    length = FixedMul(distance, distscale[x1]);
+
+    xfrac = (viewx + FixedMul(finecosine[angle], length)) >> miplevel;
+    yfrac = (viewyneg - FixedMul(finesine[angle], length)) >> miplevel;
+
+    ds_frac = ((xfrac << 10) & 0xFFFF0000) | ((yfrac >> 6) & 0xFFFF);
+
     // high or low detail
     spanfunc();
 }
@@ -403,7 +446,9 @@ void R_DrawPlanes(void)
 
         // regular flat
 
-        ds_source = W_CacheLumpNum(firstflat + flattranslation[pl->picnum], PU_CACHE);
+        planeflat = flattranslation[pl->picnum];
+        planesource = W_CacheLumpNum(firstflat + planeflat, PU_CACHE);
+        ds_source = planesource;
         planeheight = abs(pl->height - viewz);
         light = (pl->lightlevel >> LIGHTSEGSHIFT) + extralight;
 
@@ -17,6 +17,7 @@
 //
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "i_system.h"
 #include "options.h"
@@ -89,6 +90,37 @@ lighttable_t **walllights;
 
 short *maskedtexturecol;
 
+boolean reciprocalScale;
+
+// Scale and inverse of the last inverted column
+static fixed_t recipscale;
+static unsigned int recipiscale;
+
+//
+// R_InvertScale
+// Neighbouring columns have nearly the same scale, so the previous
+// inverse is refined with a Newton step when the scale moved less
+// than 1/64. The result is within about 1/1024 of the divide,
+// limited by fixed point rounding at near scales.
+//
+static unsigned int R_InvertScale(fixed_t scale)
+{
+	fixed_t delta;
+
+	delta = scale - recipscale;
+	if (delta < 0)
+		delta = -delta;
+
+	if (reciprocalScale && delta <= (scale >> 6))
+		recipiscale = ReciprocalNewton(recipiscale, scale);
+	else
+		recipiscale = 0xffffffffu / (unsigned)scale;
+
+	recipscale = scale;
+
+	return recipiscale;
+}
+
 //
 // R_RenderMaskedSegRange
 //
@@ -186,8 +218,7 @@ void R_RenderMaskedSegRange(drawseg_t *ds,
 
 			sprtopscreen = centeryfrac - FixedMulEDX(spryscale, dc_texturemid);
 
-			// VITI95: OPTIMIZE
-			dc_iscale = 0xffffffffu / (unsigned)spryscale;
+			dc_iscale = R_InvertScale(spryscale);
 
 			// draw the texture
 
@@ -789,8 +820,7 @@ void R_RenderMaskedSegRange2(drawseg_t *ds)
 
 			sprtopscreen = centeryfrac - FixedMulEDX(spryscale, dc_texturemid);
 
-			// VITI95: OPTIMIZE
-			dc_iscale = 0xffffffffu / (unsigned)spryscale;
+			dc_iscale = R_InvertScale(spryscale);
 
 			// draw the texture
 
@@ -1295,6 +1325,130 @@ void R_RenderMaskedSegRange2Flatter(drawseg_t *ds)
 	} while (dc_x <= ds->x2);
 }
 
+//
+// Deferred wall columns
+// Walls never overlap each other, so with -deferWalls their columns are
+// recorded and drawn after the BSP traversal, grouped by texture and
+// light level. The buffer is flushed before anything that may purge the
+// cached textures the recorded columns point into.
+//
+#define MAXWALLCOLUMNS (SCREENWIDTH * 4)
+
+typedef struct
+{
+	byte *source;
+	lighttable_t *colormap;
+	fixed_t iscale;
+	fixed_t texturemid;
+	short x;
+	short yl;
+	short yh;
+	short tex;
+	int light;
+} wallcolumn_t;
+
+static wallcolumn_t wallcolumns[MAXWALLCOLUMNS];
+static unsigned short wallsorted[MAXWALLCOLUMNS];
+static unsigned short wallorder[MAXWALLCOLUMNS];
+static int numwallcolumns;
+static int *walltexturecounts;
+
+void R_InitWallColumns(void)
+{
+	walltexturecounts = Z_MallocUnowned((numtextures + 1) * sizeof(int), PU_STATIC);
+}
+
+//
+// R_FlushWallColumns
+// Stable counting sort by light level, then by texture.
+// Keeps the dc_ state of the column being set up by the caller.
+//
+void R_FlushWallColumns(void)
+{
+	int lightcounts[34 + 1];
+	wallcolumn_t saved;
+	wallcolumn_t *wc;
+	int i;
+
+	if (!numwallcolumns)
+		return;
+
+	saved.x = dc_x;
+	saved.yl = dc_yl;
+	saved.yh = dc_yh;
+	saved.source = dc_source;
+	saved.colormap = dc_colormap;
+	saved.iscale = dc_iscale;
+	saved.texturemid = dc_texturemid;
+
+	memset(lightcounts, 0, sizeof(lightcounts));
+
+	for (i = 0; i < numwallcolumns; i++)
+		lightcounts[wallcolumns[i].light + 1]++;
+
+	for (i = 1; i <= 34; i++)
+		lightcounts[i] += lightcounts[i - 1];
+
+	for (i = 0; i < numwallcolumns; i++)
+		wallsorted[lightcounts[wallcolumns[i].light]++] = i;
+
+	memset(walltexturecounts, 0, (numtextures + 1) * sizeof(int));
+
+	for (i = 0; i < numwallcolumns; i++)
+		walltexturecounts[wallcolumns[i].tex + 1]++;
+
+	for (i = 1; i <= numtextures; i++)
+		walltexturecounts[i] += walltexturecounts[i - 1];
+
+	for (i = 0; i < numwallcolumns; i++)
+		wallorder[walltexturecounts[wallcolumns[wallsorted[i]].tex]++] = wallsorted[i];
+
+	for (i = 0; i < numwallcolumns; i++)
+	{
+		wc = &wallcolumns[wallorder[i]];
+
+		dc_x = wc->x;
+		dc_yl = wc->yl;
+		dc_yh = wc->yh;
+		dc_source = wc->source;
+		dc_colormap = wc->colormap;
+		dc_iscale = wc->iscale;
+		dc_texturemid = wc->texturemid;
+
+		colfunc();
+	}
+
+	numwallcolumns = 0;
+
+	dc_x = saved.x;
+	dc_yl = saved.yl;
+	dc_yh = saved.yh;
+	dc_source = saved.source;
+	dc_colormap = saved.colormap;
+	dc_iscale = saved.iscale;
+	dc_texturemid = saved.texturemid;
+}
+
+static void R_DeferWallColumn(int tex)
+{
+	wallcolumn_t *wc;
+
+	if (numwallcolumns == MAXWALLCOLUMNS)
+		R_FlushWallColumns();
+
+	wc = &wallcolumns[numwallcolumns++];
+
+	wc->source = dc_source;
+	wc->colormap = dc_colormap;
+	wc->iscale = dc_iscale;
+	wc->texturemid = dc_texturemid;
+	wc->x = dc_x;
+	wc->yl = dc_yl;
+	wc->yh = dc_yh;
+	wc->tex = tex;
+	wc->light = (dc_colormap - colormaps) >> 8;
+}
+
 //
 // R_RenderSegLoop
 // Draws zero, one, or two textures (and possibly a masked
@@ -1336,6 +1490,8 @@ void R_RenderSegLoop(void)
 	int cc_rwx;
 	int fc_rwx;
 
+	int miplevel = 0;
+
 #if defined(MODE_MDA)
 	int first = rw_x;
 #endif
@@ -1408,8 +1564,20 @@ void R_RenderSegLoop(void)
 			dc_colormap = walllights[index];
 			dc_x = rw_x;
 
-			// VITI95: OPTIMIZE
-			dc_iscale = 0xffffffffu / (unsigned)rw_scale;
+			dc_iscale = R_InvertScale(rw_scale);
+
+			// pick a smaller texture for distant columns
+			if (mipmapWalls)
+			{
+				if (rw_scale < MIPSCALE2)
+					miplevel = 2;
+				else if (rw_scale < MIPSCALE1)
+					miplevel = 1;
+				else
+					miplevel = 0;
+
+				dc_iscale >>= miplevel;
+			}
 		}
 
 		// draw the wall tiers
@@ -1425,24 +1593,44 @@ void R_RenderSegLoop(void)
 				// single sided line
 				dc_yl = yl;
 				dc_yh = yh;
-				dc_texturemid = rw_midtexturemid;
+				dc_texturemid = rw_midtexturemid >> miplevel;
 
 				tex = midtexture;
 				col = texturecolumn;
 				col &= texturewidthmask[tex];
-				lump = texturecolumnlump[tex][col];
-				ofs = texturecolumnofs[tex][col];
 
-				if (lump > 0)
+				if (miplevel)
 				{
-					dc_source = (byte *)W_CacheLumpNum(lump, PU_CACHE) + ofs;
+					if (!texturemipmaps[miplevel][tex])
+					{
+						R_FlushWallColumns();
+						R_GenerateMipmap(tex, miplevel);
+					}
+
+					dc_source = texturemipmaps[miplevel][tex] + ((col >> miplevel) << 7);
 				}
 				else
 				{
-					if (!texturecomposite[tex])
-						R_GenerateComposite(tex);
+					lump = texturecolumnlump[tex][col];
+					ofs = texturecolumnofs[tex][col];
+
+					if (lump > 0)
+					{
+						if (!lumpcache[lump])
+							R_FlushWallColumns();
+
+						dc_source = (byte *)W_CacheLumpNum(lump, PU_CACHE) + ofs;
+					}
+					else
+					{
+						if (!texturecomposite[tex])
+						{
+							R_FlushWallColumns();
+							R_GenerateComposite(tex);
+						}
 
-					dc_source = texturecomposite[tex] + ofs;
+						dc_source = texturecomposite[tex] + ofs;
+					}
 				}
 
 #if defined(MODE_CGA16) || defined(MODE_CVB)
@@ -1474,7 +1662,10 @@ void R_RenderSegLoop(void)
 				else
 					R_DrawEmptyColumnTextMDA();
 #else
-				colfunc();
+				if (deferWalls)
+					R_DeferWallColumn(tex);
+				else
+					colfunc();
 #endif
 
 				cc_rwx = viewheight;
@@ -1501,24 +1692,44 @@ void R_RenderSegLoop(void)
 				{
 					dc_yl = yl;
 					dc_yh = mid;
-					dc_texturemid = rw_toptexturemid;
+					dc_texturemid = rw_toptexturemid >> miplevel;
 
 					tex = toptexture;
 					col = texturecolumn;
 					col &= texturewidthmask[tex];
-					lump = texturecolumnlump[tex][col];
-					ofs = texturecolumnofs[tex][col];
 
-					if (lump > 0)
+					if (miplevel)
 					{
-						dc_source = (byte *)W_CacheLumpNum(lump, PU_CACHE) + ofs;
+						if (!texturemipmaps[miplevel][tex])
+						{
+							R_FlushWallColumns();
+							R_GenerateMipmap(tex, miplevel);
+						}
+
+						dc_source = texturemipmaps[miplevel][tex] + ((col >> miplevel) << 7);
 					}
 					else
 					{
-						if (!texturecomposite[tex])
-							R_GenerateComposite(tex);
-
-						dc_source = texturecomposite[tex] + ofs;
+						lump = texturecolumnlump[tex][col];
+						ofs = texturecolumnofs[tex][col];
+
+						if (lump > 0)
+						{
+							if (!lumpcache[lump])
+								R_FlushWallColumns();
+
+							dc_source = (byte *)W_CacheLumpNum(lump, PU_CACHE) + ofs;
+						}
+						else
+						{
+							if (!texturecomposite[tex])
+							{
+								R_FlushWallColumns();
+								R_GenerateComposite(tex);
+							}
+
+							dc_source = texturecomposite[tex] + ofs;
+						}
 					}
 
 #if defined(MODE_CGA16) || defined(MODE_CVB)
@@ -1550,7 +1761,10 @@ void R_RenderSegLoop(void)
 					else
 						R_DrawEmptyColumnTextMDA();
 #else
-					colfunc();
+					if (deferWalls)
+						R_DeferWallColumn(tex);
+					else
+						colfunc();
 #endif
 
 					cc_rwx = mid;
@@ -1581,24 +1795,44 @@ void R_RenderSegLoop(void)
 				{
 					dc_yl = mid;
 					dc_yh = yh;
-					dc_texturemid = rw_bottomtexturemid;
+					dc_texturemid = rw_bottomtexturemid >> miplevel;
 
 					tex = bottomtexture;
 					col = texturecolumn;
 					col &= texturewidthmask[tex];
-					lump = texturecolumnlump[tex][col];
-					ofs = texturecolumnofs[tex][col];
 
-					if (lump > 0)
+					if (miplevel)
 					{
-						dc_source = (byte *)W_CacheLumpNum(lump, PU_CACHE) + ofs;
+						if (!texturemipmaps[miplevel][tex])
+						{
+							R_FlushWallColumns();
+							R_GenerateMipmap(tex, miplevel);
+						}
+
+						dc_source = texturemipmaps[miplevel][tex] + ((col >> miplevel) << 7);
 					}
 					else
 					{
-						if (!texturecomposite[tex])
-							R_GenerateComposite(tex);
-
-						dc_source = texturecomposite[tex] + ofs;
+						lump = texturecolumnlump[tex][col];
+						ofs = texturecolumnofs[tex][col];
+
+						if (lump > 0)
+						{
+							if (!lumpcache[lump])
+								R_FlushWallColumns();
+
+							dc_source = (byte *)W_CacheLumpNum(lump, PU_CACHE) + ofs;
+						}
+						else
+						{
+							if (!texturecomposite[tex])
+							{
+								R_FlushWallColumns();
+								R_GenerateComposite(tex);
+							}
+
+							dc_source = texturecomposite[tex] + ofs;
+						}
 					}
 
 #if defined(MODE_CGA16) || defined(MODE_CVB)
@@ -1630,7 +1864,10 @@ void R_RenderSegLoop(void)
 					else
 						R_DrawEmptyColumnTextMDA();
 #else
-					colfunc();
+					if (deferWalls)
+						R_DeferWallColumn(tex);
+					else
+						colfunc();
 #endif
 
 					fc_rwx = mid;
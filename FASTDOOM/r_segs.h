@@ -19,6 +19,13 @@
 #ifndef __R_SEGS__
 #define __R_SEGS__
 
+// Invert the column scale with a Newton step instead of a divide
+extern boolean reciprocalScale;
+
+// Wall columns drawn after the BSP traversal with -deferWalls
+extern void R_InitWallColumns(void);
+extern void R_FlushWallColumns(void);
+
 extern void R_RenderSegLoop(void);
 extern void R_RenderSegLoopFlat(void);
 extern void R_RenderSegLoopFlatter(void);
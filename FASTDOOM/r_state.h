@@ -69,16 +69,22 @@ extern spritedef_t sprites[NUMSPRITES];
 extern int numvertexes;
 extern vertex_t *vertexes;
 
+extern int numsegs;
 extern seg_t *segs;
 
 extern int numsectors;
 extern sector_t *sectors;
 
+extern int numsubsectors;
 extern subsector_t *subsectors;
 
 extern int firstnode;
 extern node_t *nodes;
 
+// Compact copies used by the BSP traversal
+extern rendernode_t *rendernodes;
+extern renderseg_t *rendersegs;
+
 extern int numlines;
 extern line_t *lines;
 
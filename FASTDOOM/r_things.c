@@ -279,14 +279,14 @@ fixed_t sprtopscreen;
 //
 void R_DrawVisSprite(vissprite_t *vis)
 {
-    column_t *column;
+    spritepost_t *post;
     int texturecolumn;
     fixed_t frac;
-    patch_t *patch;
+    spritepatch_t *sprite;
     fixed_t fracstep;
     fixed_t nextfrac;
 
-    patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    sprite = R_CacheSprite(vis->patch);
 
     dc_colormap = vis->colormap;
 
@@ -332,14 +332,14 @@ void R_DrawVisSprite(vissprite_t *vis)
         mcc_x = mceilingclip[dc_x];
 
         texturecolumn = frac >> FRACBITS;
-        column = (column_t *)((byte *)patch + patch->columnofs[texturecolumn]);
+        post = (spritepost_t *)((byte *)sprite + sprite->columnofs[texturecolumn]);
 
-        for (; column->topdelta != 0xff;)
+        for (; post->length; post++)
         {
             // calculate unclipped screen coordinates
             //  for post
-            topscreen = sprtopscreen + spryscale * column->topdelta;
-            bottomscreen = topscreen + spryscale * column->length;
+            topscreen = sprtopscreen + spryscale * post->topdelta;
+            bottomscreen = topscreen + spryscale * post->length;
 
             yh = (bottomscreen - 1) >> FRACBITS;
 
@@ -347,10 +347,7 @@ void R_DrawVisSprite(vissprite_t *vis)
                 yh = mfc_x - 1;
 
             if (yh >= viewheight)
-            {
-                column = (column_t *)((byte *)column + column->length + 4);
                 continue;
-            }
 
             yl = (topscreen + FRACUNIT - 1) >> FRACBITS;
 
@@ -358,13 +355,10 @@ void R_DrawVisSprite(vissprite_t *vis)
                 yl = mcc_x + 1;
 
             if (yl > yh)
-            {
-                column = (column_t *)((byte *)column + column->length + 4);
                 continue;
-            }
 
-            dc_source = (byte *)column + 3;
-            dc_texturemid = basetexturemid - (column->topdelta << FRACBITS);
+            dc_source = (byte *)sprite + post->ofs;
+            dc_texturemid = basetexturemid - (post->topdelta << FRACBITS);
             BOUNDS_CHECK(yh, yl);
             dc_yh = yh;
             dc_yl = yl;
@@ -397,8 +391,6 @@ void R_DrawVisSprite(vissprite_t *vis)
 #else
             spritefunc();
 #endif
-
-            column = (column_t *)((byte *)column + column->length + 4);
         }
 
         dc_texturemid = basetexturemid;
@@ -411,14 +403,14 @@ void R_DrawVisSprite(vissprite_t *vis)
 
 void R_DrawVisPSprite(vissprite_t *vis)
 {
-    column_t *column;
+    spritepost_t *post;
     int texturecolumn;
     fixed_t frac;
-    patch_t *patch;
+    spritepatch_t *sprite;
     fixed_t fracstep;
     fixed_t nextfrac;
 
-    patch = W_CacheLumpNum(vis->patch + firstspritelump, PU_CACHE);
+    sprite = R_CacheSprite(vis->patch);
 
     dc_colormap = vis->colormap;
 
@@ -464,14 +456,14 @@ void R_DrawVisPSprite(vissprite_t *vis)
         mcc_x = mceilingclip[dc_x];
 
         texturecolumn = frac >> FRACBITS;
-        column = (column_t *)((byte *)patch + patch->columnofs[texturecolumn]);
+        post = (spritepost_t *)((byte *)sprite + sprite->columnofs[texturecolumn]);
 
-        for (; column->topdelta != 0xff;)
+        for (; post->length; post++)
         {
             // calculate unclipped screen coordinates
             //  for post
-            topscreen = sprtopscreen + spryscale * column->topdelta;
-            bottomscreen = topscreen + spryscale * column->length;
+            topscreen = sprtopscreen + spryscale * post->topdelta;
+            bottomscreen = topscreen + spryscale * post->length;
 
             yh = (bottomscreen - 1) >> FRACBITS;
 
@@ -479,10 +471,7 @@ void R_DrawVisPSprite(vissprite_t *vis)
                 yh = mfc_x - 1;
 
             if (yh >= viewheight)
-            {
-                column = (column_t *)((byte *)column + column->length + 4);
                 continue;
-            }
 
             yl = (topscreen + FRACUNIT - 1) >> FRACBITS;
 
@@ -490,13 +479,10 @@ void R_DrawVisPSprite(vissprite_t *vis)
                 yl = mcc_x + 1;
 
             if (yl > yh)
-            {
-                column = (column_t *)((byte *)column + column->length + 4);
                 continue;
-            }
 
-            dc_source = (byte *)column + 3;
-            dc_texturemid = basetexturemid - (column->topdelta << FRACBITS);
+            dc_source = (byte *)sprite + post->ofs;
+            dc_texturemid = basetexturemid - (post->topdelta << FRACBITS);
             BOUNDS_CHECK(yh, yl);
             dc_yh = yh;
             dc_yl = yl;
@@ -529,8 +515,6 @@ void R_DrawVisPSprite(vissprite_t *vis)
 #else
             pspritefunc();
 #endif
-
-            column = (column_t *)((byte *)column + column->length + 4);
         }
 
         dc_texturemid = basetexturemid;
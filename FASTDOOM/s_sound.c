@@ -40,6 +40,7 @@
 #include "std_func.h"
 
 #include "ns_cd.h"
+#include "ns_task.h"
 #include "ns_multi.h"
 #include "ns_muldf.h"
 
@@ -59,6 +60,13 @@ extern int snd_DesiredMidiDevice;
 int cdlooping = 0;
 int cdmusicnum = 0;
 
+// Seconds until the CD track should end, counted by a 1Hz task so
+//  the main loop only asks MSCDEX for the status once it's due
+#define CD_FRAMES_PER_SECOND 75
+static task *cdtask = NULL;
+static volatile int cdsecondsleft;
+static volatile byte cdcheckstatus;
+
 int wavhandle = -1;
 int wavmusicnum = 0;
 int wavlooping = 0;
@@ -75,11 +83,39 @@ typedef struct
     // handle of the sound being played
     int handle;
 
+    // next channel in the same origin hash chain
+    int hashnext;
+
+    // index in the priority heap
+    int heappos;
+
+    // origin and listener the parameters were last computed for
+    fixed_t x;
+    fixed_t y;
+    fixed_t listenerx;
+    fixed_t listenery;
+    angle_t listenerangle;
+    int sfxvolume;
+
 } channel_t;
 
 // the set of channels available
 static channel_t *channels;
 
+// Busy channels hashed by origin, an origin has one channel at most
+#define ORIGINHASHSIZE 64
+#define ORIGINHASH(o) ((((unsigned int)(o)) >> 4) & (ORIGINHASHSIZE - 1))
+static int originhash[ORIGINHASHSIZE];
+
+// Busy channels as a heap, the one with the lowest
+//  priority (highest value) on top
+static int *channelheap;
+static int numbusychannels;
+
+// Channels ready to be used
+static int *freechannels;
+static int numfreechannels;
+
 // These are not used, but should be (menu).
 // Maximum volume of a sound effect.
 // Internal default is max out of 0-15.
@@ -332,6 +368,17 @@ unsigned char S_MapMusicCD(int musicnum)
     }
 }
 
+static void S_CDTask(task *t)
+{
+    if (mus_paused)
+        return;
+
+    if (cdsecondsleft > 0)
+        cdsecondsleft--;
+    else
+        cdcheckstatus = 1; // Keep checking once per second
+}
+
 void S_ChangeMusicCD(int musicnum, int looping)
 {
     int cdtrack;
@@ -344,12 +391,26 @@ void S_ChangeMusicCD(int musicnum, int looping)
     if (cdtrack > CD_Cdrom_data.High_audio)
         cdtrack = cdtrack % CD_Cdrom_data.High_audio;
 
+    cdsecondsleft = (TrackLength[cdtrack] + CD_FRAMES_PER_SECOND - 1) / CD_FRAMES_PER_SECOND;
+    cdcheckstatus = 0;
+
+    if (!cdtask)
+    {
+        cdtask = TS_ScheduleTask(S_CDTask, 1, 1, NULL);
+        TS_Dispatch();
+    }
+
     CD_StopAudio();
     CD_PlayAudio(TrackBeginPosition[cdtrack], TrackLength[cdtrack]);
 }
 
 void S_CheckCD(void)
 {
+    if (!cdcheckstatus)
+        return;
+
+    cdcheckstatus = 0;
+
     if (cdlooping && !mus_paused)
     {
         CD_GetAudioStatus();
@@ -581,10 +642,106 @@ void S_ChangeMusic(int musicnum, int looping)
     }
 }
 
-void S_StopChannel(int cnum)
+//
+// Channel bookkeeping
+//
+static void S_SwapHeapChannels(int i, int j)
 {
+    int cnum = channelheap[i];
 
-    int i;
+    channelheap[i] = channelheap[j];
+    channelheap[j] = cnum;
+
+    channels[channelheap[i]].heappos = i;
+    channels[channelheap[j]].heappos = j;
+}
+
+static void S_SiftChannelUp(int i)
+{
+    int parent;
+
+    while (i > 0)
+    {
+        parent = (i - 1) >> 1;
+
+        if (channels[channelheap[parent]].sfxinfo->priority >= channels[channelheap[i]].sfxinfo->priority)
+            break;
+
+        S_SwapHeapChannels(i, parent);
+        i = parent;
+    }
+}
+
+static void S_SiftChannelDown(int i)
+{
+    int child;
+
+    while ((child = (i << 1) + 1) < numbusychannels)
+    {
+        if (child + 1 < numbusychannels && channels[channelheap[child + 1]].sfxinfo->priority > channels[channelheap[child]].sfxinfo->priority)
+            child++;
+
+        if (channels[channelheap[i]].sfxinfo->priority >= channels[channelheap[child]].sfxinfo->priority)
+            break;
+
+        S_SwapHeapChannels(i, child);
+        i = child;
+    }
+}
+
+static void S_LinkChannel(int cnum)
+{
+    channel_t *c = &channels[cnum];
+    int *head = &originhash[ORIGINHASH(c->origin)];
+
+    c->hashnext = *head;
+    *head = cnum;
+
+    c->heappos = numbusychannels;
+    channelheap[numbusychannels++] = cnum;
+    S_SiftChannelUp(c->heappos);
+}
+
+static void S_UnlinkChannel(int cnum)
+{
+    channel_t *c = &channels[cnum];
+    int *link = &originhash[ORIGINHASH(c->origin)];
+    int pos;
+
+    while (*link != cnum)
+        link = &channels[*link].hashnext;
+
+    *link = c->hashnext;
+
+    // Move the last channel of the heap to the hole
+    pos = c->heappos;
+    numbusychannels--;
+
+    if (pos != numbusychannels)
+    {
+        S_SwapHeapChannels(pos, numbusychannels);
+        S_SiftChannelUp(pos);
+        S_SiftChannelDown(pos);
+    }
+
+    freechannels[numfreechannels++] = cnum;
+}
+
+static int S_FindChannel(void *origin)
+{
+    int cnum;
+
+    for (cnum = originhash[ORIGINHASH(origin)]; cnum != -1; cnum = channels[cnum].hashnext)
+    {
+        if (channels[cnum].origin == origin)
+            return cnum;
+    }
+
+    return -1;
+}
+
+void S_StopChannel(int cnum)
+{
     channel_t *c = &channels[cnum];
 
     if (c->sfxinfo)
@@ -594,10 +751,27 @@ void S_StopChannel(int cnum)
         {
             SFX_StopPatch(c->handle);
         }
+
+        S_UnlinkChannel(cnum);
         c->sfxinfo = 0;
     }
 }
 
+//
+// S_SaveSoundParams
+// Remembers the positions the channel parameters are computed for,
+//  so S_UpdateSounds can skip them until something moves.
+//
+static void S_SaveSoundParams(channel_t *c, mobj_t *origin)
+{
+    c->x = origin->x;
+    c->y = origin->y;
+    c->listenerx = players_mo->x;
+    c->listenery = players_mo->y;
+    c->listenerangle = players_mo->angle;
+    c->sfxvolume = snd_SfxVolume;
+}
+
 //
 // Changes volume, stereo-separation, and pitch variables
 //  from the norm of a sound effect to be played.
@@ -725,16 +899,264 @@ void S_StopSound(void *origin)
     if (snd_SfxDevice == snd_none)
         return;
 
-    for (cnum = 0; cnum < numChannels; cnum++)
+    cnum = S_FindChannel(origin);
+
+    if (cnum != -1)
+        S_StopChannel(cnum);
+}
+
+//
+// S_CacheSfx
+// Loads a sound effect, converted to the mix rate if requested.
+//
+void S_CacheSfx(sfxinfo_t *sfx)
+{
+    void *resampled;
+
+    sfx->data = (void *)W_CacheLumpNum(sfx->lumpnum, PU_SOUND);
+
+    if (resampleSfx)
     {
-        if (channels[cnum].sfxinfo && channels[cnum].origin == origin)
+        resampled = SFX_ResamplePatch(sfx->data);
+
+        if (resampled)
         {
-            S_StopChannel(cnum);
-            break;
+            Z_ChangeTag(sfx->data, PU_CACHE);
+            sfx->data = resampled;
         }
     }
 }
 
+//
+// S_SfxMemory
+// Size of the block holding a cached sound effect
+//
+static int S_SfxMemory(sfxinfo_t *sfx)
+{
+    byte *data = (byte *)sfx->data;
+
+    // Resampled copies are laid out like the lump, the header
+    // length covers the padded samples
+    if (data != lumpcache[sfx->lumpnum])
+        return 8 + (data[4] | (data[5] << 8) | (data[6] << 16) | (data[7] << 24));
+
+    return W_LumpLength(sfx->lumpnum);
+}
+
+//
+// S_PrecacheLevel
+// Loads the sound effects the level can play, so the first time
+// one is heard it doesn't have to be read from disk.
+//
+int sfxmemory;
+
+// Sounds the player can trigger on any level
+static const byte playersfx[] =
+    {
+        sfx_pistol, sfx_shotgn, sfx_punch, sfx_bfg,
+        sfx_sawup, sfx_sawidl, sfx_sawful, sfx_sawhit,
+        sfx_dshtgn, sfx_dbopn, sfx_dbload, sfx_dbcls,
+        sfx_itemup, sfx_wpnup, sfx_getpow,
+        sfx_oof, sfx_noway, sfx_slop, sfx_pdiehi,
+        sfx_telept, sfx_swtchn, sfx_swtchx};
+
+// Sounds played by action functions instead of through mobjinfo
+typedef struct
+{
+    mobjtype_t type;
+    byte sfx[4];
+} actionsfx_t;
+
+static const actionsfx_t actionsfx[] =
+    {
+        {MT_TROOP, {sfx_claw}},
+        {MT_BRUISER, {sfx_claw}},
+        {MT_KNIGHT, {sfx_claw}},
+        {MT_UNDEAD, {sfx_skeswg, sfx_skepch}},
+        {MT_VILE, {sfx_vilatk, sfx_flamst, sfx_flame, sfx_barexp}},
+        {MT_FATSO, {sfx_manatk}},
+        {MT_SPIDER, {sfx_metal}},
+        {MT_CYBORG, {sfx_hoof, sfx_metal}},
+        {MT_BABY, {sfx_bspwlk}},
+        {MT_BOSSBRAIN, {sfx_bospn, sfx_bosdth}},
+        {MT_BOSSSPIT, {sfx_bossit, sfx_bospit, sfx_boscub, sfx_telept}}};
+
+static void S_MarkSfx(byte *sfxpresent, int sfx_id)
+{
+    // A_Look and A_Scream pick one of these at random
+    switch (sfx_id)
+    {
+    case sfx_posit1:
+    case sfx_posit2:
+    case sfx_posit3:
+        sfxpresent[sfx_posit1] = sfxpresent[sfx_posit2] = sfxpresent[sfx_posit3] = 1;
+        break;
+    case sfx_bgsit1:
+    case sfx_bgsit2:
+        sfxpresent[sfx_bgsit1] = sfxpresent[sfx_bgsit2] = 1;
+        break;
+    case sfx_podth1:
+    case sfx_podth2:
+    case sfx_podth3:
+        sfxpresent[sfx_podth1] = sfxpresent[sfx_podth2] = sfxpresent[sfx_podth3] = 1;
+        break;
+    case sfx_bgdth1:
+    case sfx_bgdth2:
+        sfxpresent[sfx_bgdth1] = sfxpresent[sfx_bgdth2] = 1;
+        break;
+    default:
+        sfxpresent[sfx_id] = 1;
+        break;
+    }
+}
+
+static void S_MarkMobjSfx(byte *sfxpresent, mobjinfo_t *info)
+{
+    S_MarkSfx(sfxpresent, info->seesound);
+    S_MarkSfx(sfxpresent, info->attacksound);
+    S_MarkSfx(sfxpresent, info->painsound);
+    S_MarkSfx(sfxpresent, info->deathsound);
+    S_MarkSfx(sfxpresent, info->activesound);
+}
+
+//
+// S_MarkLineSfx
+// Marks the sounds of the movers a line special can start.
+// The cases follow the EV_ calls of P_CrossSpecialLine and
+// P_ShootSpecialLine (p_spec.c) and P_UseSpecialLine (p_switch.c),
+// keep them in sync when a special is added there.
+//
+static void S_MarkLineSfx(byte *sfxpresent, short special)
+{
+    switch (special)
+    {
+    // Doors
+    case 1: case 2: case 3: case 4: case 16: case 26: case 27: case 28:
+    case 29: case 31: case 32: case 33: case 34: case 42: case 46: case 50:
+    case 61: case 63: case 75: case 76: case 86: case 90: case 103:
+        sfxpresent[sfx_doropn] = sfxpresent[sfx_dorcls] = 1;
+        break;
+
+    // Blazing doors
+    case 99: case 105: case 106: case 107: case 108: case 109: case 110:
+    case 111: case 112: case 113: case 114: case 115: case 116: case 117:
+    case 118: case 133: case 134: case 135: case 136: case 137:
+        sfxpresent[sfx_bdopn] = sfxpresent[sfx_bdcls] = 1;
+        break;
+
+    // Plats and lifts
+    case 10: case 14: case 15: case 20: case 21: case 22: case 47: case 53:
+    case 62: case 66: case 67: case 68: case 87: case 88: case 95: case 120:
+    case 121: case 122: case 123:
+        sfxpresent[sfx_pstart] = sfxpresent[sfx_pstop] = sfxpresent[sfx_stnmov] = 1;
+        break;
+
+    // Floors, ceilings, crushers, stairs and donuts
+    case 5: case 6: case 7: case 8: case 9: case 18: case 19: case 23:
+    case 24: case 25: case 30: case 36: case 37: case 38: case 40: case 41:
+    case 43: case 44: case 45: case 49: case 55: case 56: case 58: case 59:
+    case 60: case 64: case 65: case 69: case 70: case 71: case 72: case 73:
+    case 77: case 82: case 83: case 84: case 91: case 92: case 93: case 94:
+    case 96: case 98: case 100: case 101: case 102: case 119: case 127: case 128:
+    case 129: case 130: case 131: case 132: case 140: case 141:
+        sfxpresent[sfx_stnmov] = sfxpresent[sfx_pstop] = 1;
+        break;
+
+    // Teleports
+    case 39: case 97: case 125: case 126:
+        sfxpresent[sfx_telept] = 1;
+        break;
+    }
+}
+
+void S_PrecacheLevel(void)
+{
+    byte sfxpresent[NUMSFX];
+    byte typepresent[NUMMOBJTYPES];
+
+    int i;
+    int j;
+    thinker_t *th;
+    sfxinfo_t *sfx;
+
+    sfxmemory = 0;
+
+    if (snd_SfxDevice == snd_none)
+        return;
+
+    memset(sfxpresent, 0, sizeof(sfxpresent));
+    memset(typepresent, 0, sizeof(typepresent));
+
+    // Things placed on the map, tickless ones included
+    for (th = thinkercap.next; th != &thinkercap; th = th->next)
+    {
+        if (th->function.acp1 == (actionf_p1)P_MobjThinker || th->function.acp1 == (actionf_p1)P_MobjBrainlessThinker || th->function.acp1 == (actionf_p1)P_MobjTicklessThinker)
+            typepresent[((mobj_t *)th)->type] = 1;
+    }
+
+    for (th = staticthinkercap.next; th != &staticthinkercap; th = th->next)
+        typepresent[((mobj_t *)th)->type] = 1;
+
+    // Things that are spawned later on
+    typepresent[MT_PLAYER] = 1;
+    typepresent[MT_TFOG] = 1;
+    typepresent[MT_IFOG] = 1;
+
+    if (typepresent[MT_PAIN])
+        typepresent[MT_SKULL] = 1;
+
+    for (i = 0; i < NUMMOBJTYPES; i++)
+    {
+        // Anything can come out of the boss shooter
+        if (typepresent[MT_BOSSSPIT] && (mobjinfo[i].flags & MF_COUNTKILL))
+            typepresent[i] = 1;
+
+        // Missiles are fired by the player and the monsters
+        if (typepresent[i] || (mobjinfo[i].flags & MF_MISSILE))
+            S_MarkMobjSfx(sfxpresent, &mobjinfo[i]);
+    }
+
+    for (i = 0; i < sizeof(actionsfx) / sizeof(actionsfx[0]); i++)
+    {
+        if (!typepresent[actionsfx[i].type])
+            continue;
+
+        for (j = 0; j < 4 && actionsfx[i].sfx[j]; j++)
+            sfxpresent[actionsfx[i].sfx[j]] = 1;
+    }
+
+    for (i = 0; i < sizeof(playersfx); i++)
+        sfxpresent[playersfx[i]] = 1;
+
+    // Movers started by lines and sectors
+    for (i = 0; i < numlines; i++)
+        S_MarkLineSfx(sfxpresent, lines[i].special);
+
+    for (i = 0; i < numsectors; i++)
+    {
+        // Doors that close in 30 seconds or open in 5 minutes
+        if (sectors[i].special == 10 || sectors[i].special == 14)
+            sfxpresent[sfx_doropn] = sfxpresent[sfx_dorcls] = 1;
+    }
+
+    for (i = 1; i < NUMSFX; i++)
+    {
+        if (!sfxpresent[i])
+            continue;
+
+        sfx = &S_sfx[i];
+
+        // Not in this IWAD
+        if (sfx->lumpnum < 0)
+            continue;
+
+        if (!sfx->data)
+            S_CacheSfx(sfx);
+
+        sfxmemory += S_SfxMemory(sfx);
+    }
+}
+
 //
 // S_getChannel :
 //   If none available, return -1.  Otherwise channel #.
@@ -746,43 +1168,38 @@ int S_getChannel(void *origin, sfxinfo_t *sfxinfo)
 
     channel_t *c;
 
-    // Find an open channel
-    for (cnum = 0; cnum < numChannels; cnum++)
+    // Reuse the channel of the same origin
+    if (origin)
     {
-        if (!channels[cnum].sfxinfo)
-            break;
-        else if (origin && channels[cnum].origin == origin)
-        {
+        cnum = S_FindChannel(origin);
+
+        if (cnum != -1)
             S_StopChannel(cnum);
-            break;
-        }
     }
 
     // None available
-    if (cnum == numChannels)
+    if (numfreechannels == 0)
     {
         // Look for lower priority
-        for (cnum = 0; cnum < numChannels; cnum++)
-            if (channels[cnum].sfxinfo->priority >= sfxinfo->priority)
-                break;
+        cnum = channelheap[0];
 
-        if (cnum == numChannels)
+        if (channels[cnum].sfxinfo->priority < sfxinfo->priority)
         {
             // FUCK!  No lower priority.  Sorry, Charlie.
             return -1;
         }
-        else
-        {
-            // Otherwise, kick out lower priority.
-            S_StopChannel(cnum);
-        }
+
+        // Otherwise, kick out lower priority.
+        S_StopChannel(cnum);
     }
 
+    cnum = freechannels[--numfreechannels];
     c = &channels[cnum];
 
     // channel is decided to be cnum.
     c->sfxinfo = sfxinfo;
     c->origin = origin;
+    S_LinkChannel(cnum);
 
     return cnum;
 }
@@ -831,21 +1248,18 @@ void S_StartSound(mobj_t *origin, byte sfx_id)
     if (cnum < 0)
         return;
 
-    //
-    // This is supposed to handle the loading/caching.
-    // For some odd reason, the caching is done nearly
-    //  each time the sound is needed?
-    //
-
     // cache data if necessary
     if (!sfx->data)
     {
-        sfx->data = (void *)W_CacheLumpNum(sfx->lumpnum, PU_SOUND);
+        S_CacheSfx(sfx);
     }
 
     // Assigns the handle to one of the channels in the
     //  mix/output buffer.
     channels[cnum].handle = SFX_PlayPatch(sfx->data, sep, volume);
+
+    if (origin && origin != players_mo)
+        S_SaveSoundParams(&channels[cnum], origin);
 }
 
 //
@@ -875,7 +1289,17 @@ void S_UpdateSounds(void)
                 //  or modify their params
                 if (c->origin && players_mo != c->origin)
                 {
-                    byte audible = S_AdjustSoundParams(c->origin, &volume, &sep);
+                    mobj_t *origin = (mobj_t *)c->origin;
+                    byte audible;
+
+                    // Neither the source nor the listener moved
+                    if (origin->x == c->x && origin->y == c->y &&
+                        players_mo->x == c->listenerx && players_mo->y == c->listenery &&
+                        players_mo->angle == c->listenerangle && snd_SfxVolume == c->sfxvolume)
+                        continue;
+
+                    S_SaveSoundParams(c, origin);
+                    audible = S_AdjustSoundParams(origin, &volume, &sep);
 
                     if (audible)
                     {
@@ -912,10 +1336,21 @@ void S_Init(int sfxVolume, int musicVolume)
     // (the maximum numer of sounds rendered
     // simultaneously) within zone memory.
     channels = (channel_t *)Z_MallocUnowned(numChannels * sizeof(channel_t), PU_STATIC);
+    channelheap = (int *)Z_MallocUnowned(numChannels * sizeof(int), PU_STATIC);
+    freechannels = (int *)Z_MallocUnowned(numChannels * sizeof(int), PU_STATIC);
 
     // Free all channels for use
     for (i = 0; i < numChannels; i++)
+    {
         channels[i].sfxinfo = 0;
+        freechannels[i] = numChannels - 1 - i;
+    }
+
+    numfreechannels = numChannels;
+    numbusychannels = 0;
+
+    for (i = 0; i < ORIGINHASHSIZE; i++)
+        originhash[i] = -1;
 
     // no sounds are playing, and they are not mus_paused
     mus_paused = 0;
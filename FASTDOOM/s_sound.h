@@ -21,6 +21,7 @@
 
 #include "doomtype.h"
 #include "p_mobj.h"
+#include "sounds.h"
 
 #define S_MAX_VOLUME 127
 
@@ -59,6 +60,11 @@ void S_Start(void);
 //  using <sound_id> from sounds.h
 //
 void S_StartSound(mobj_t *origin, byte sound_id);
+void S_CacheSfx(sfxinfo_t *sfx);
+
+// Loads the sound effects the level can play
+void S_PrecacheLevel(void);
+extern int sfxmemory;
 
 // Stop sound for thing at <origin>
 void S_StopSound(void *origin);
@@ -0,0 +1,577 @@
+#!/usr/bin/env python3
+#
+# Builds the potentially visible sets (PVS) used by the FastDoom renderer.
+#
+# For every subsector of a map, finds the subsectors that can be seen from
+# anywhere inside it. Only one-sided lines block the view, so the result
+# stays valid whatever the doors, lifts and floors of the map do.
+#
+# The sets are written to a PWAD, one PVSExMy / PVSMAPxx lump per map:
+#
+#   int32 numsubsectors
+#   int32 offsets[numsubsectors]   row offset from the start of the lump
+#   rows                           a bit per subsector, zero bytes are
+#                                  stored as a 0 followed by a count
+#
+# Usage: python fastdoom_pvs.py doom.wad pvs.wad [E1M1 E1M2 ...]
+# Then start FastDoom with -file pvs.wad
+#
+
+import math
+import re
+import struct
+import sys
+from collections import deque
+
+NF_SUBSECTOR = 0x8000
+
+# Map units. Rounded vertices of split segs can be off by half a unit.
+EPSILON = 1.0
+# Windows narrower than this can't show a pixel
+MIN_WINDOW = 0.01
+# Times a portal is walked again with wider windows before opening it
+MAX_WALKS = 2
+
+MAP_LUMPS = ("THINGS", "LINEDEFS", "SIDEDEFS", "VERTEXES", "SEGS",
+             "SSECTORS", "NODES", "SECTORS", "REJECT", "BLOCKMAP")
+
+
+def read_wad(filename):
+    with open(filename, "rb") as f:
+        data = f.read()
+
+    ident, numlumps, infotableofs = struct.unpack_from("<4sii", data, 0)
+    if ident not in (b"IWAD", b"PWAD"):
+        raise ValueError(filename + " is not a WAD file")
+
+    lumps = []
+    for i in range(numlumps):
+        filepos, size, name = struct.unpack_from("<ii8s", data, infotableofs + i * 16)
+        name = name.split(b"\0")[0].decode("ascii", "replace").upper()
+        lumps.append((name, data[filepos:filepos + size]))
+
+    return lumps
+
+
+def write_wad(filename, lumps):
+    directory = b""
+    body = b""
+    offset = 12
+
+    for name, data in lumps:
+        directory += struct.pack("<ii8s", offset, len(data), name.encode("ascii"))
+        body += data
+        offset += len(data)
+
+    with open(filename, "wb") as f:
+        f.write(struct.pack("<4sii", b"PWAD", len(lumps), offset))
+        f.write(body)
+        f.write(directory)
+
+
+def find_maps(lumps):
+    maps = {}
+
+    for i, (name, data) in enumerate(lumps):
+        if not re.match(r"^(E\dM\d|MAP\d\d)$", name):
+            continue
+
+        maplumps = {}
+        for lumpname, lumpdata in lumps[i + 1:i + 1 + len(MAP_LUMPS)]:
+            if lumpname in MAP_LUMPS:
+                maplumps[lumpname] = lumpdata
+
+        maps[name] = maplumps
+
+    return maps
+
+
+class Map:
+    def __init__(self, maplumps):
+        self.vertexes = [v for v in struct.iter_unpack("<hh", maplumps["VERTEXES"])]
+        self.linedefs = [l for l in struct.iter_unpack("<HHhhhHH", maplumps["LINEDEFS"])]
+        self.segs = [s for s in struct.iter_unpack("<HHhHhh", maplumps["SEGS"])]
+        self.subsectors = [s for s in struct.iter_unpack("<HH", maplumps["SSECTORS"])]
+        self.nodes = [n for n in struct.iter_unpack("<hhhh8hHH", maplumps["NODES"])]
+
+    def seg_line(self, seg):
+        v1 = self.vertexes[seg[0]]
+        v2 = self.vertexes[seg[1]]
+        return (float(v1[0]), float(v1[1]), float(v2[0] - v1[0]), float(v2[1] - v1[1]))
+
+    def seg_blocks(self, seg):
+        # One-sided lines
+        return self.linedefs[seg[3]][6] == 0xFFFF
+
+    def point_in_subsector(self, x, y):
+        if not self.nodes:
+            return 0
+
+        num = len(self.nodes) - 1
+        while not num & NF_SUBSECTOR:
+            node = self.nodes[num]
+            num = node[13 - (side(node[0], node[1], node[2], node[3], x, y) < 0)]
+
+        return num & ~NF_SUBSECTOR
+
+
+# Positive on the left of the line, negative on the right (front) side
+def side(ox, oy, dx, dy, x, y):
+    return dx * (y - oy) - dy * (x - ox)
+
+
+# Keeps the part of a convex polygon on one side of a line
+def clip_polygon(poly, ox, oy, dx, dy, keepleft):
+    result = []
+    sign = 1.0 if keepleft else -1.0
+    count = len(poly)
+
+    for i in range(count):
+        p1 = poly[i]
+        p2 = poly[(i + 1) % count]
+        s1 = side(ox, oy, dx, dy, p1[0], p1[1]) * sign
+        s2 = side(ox, oy, dx, dy, p2[0], p2[1]) * sign
+
+        if s1 >= 0:
+            result.append(p1)
+        if (s1 >= 0) != (s2 >= 0):
+            t = s1 / (s1 - s2)
+            result.append((p1[0] + (p2[0] - p1[0]) * t, p1[1] + (p2[1] - p1[1]) * t))
+
+    return result
+
+
+def polygon_area(poly):
+    area = 0.0
+    for i in range(len(poly)):
+        x1, y1 = poly[i]
+        x2, y2 = poly[(i + 1) % len(poly)]
+        area += x1 * y2 - x2 * y1
+    return area / 2
+
+
+# Convex region of every subsector: the BSP partitions cut the map
+# bounds, the segs of the subsector cut away the void behind them.
+def build_polygons(m):
+    polygons = [None] * len(m.subsectors)
+
+    xs = [v[0] for v in m.vertexes]
+    ys = [v[1] for v in m.vertexes]
+    bounds = [(min(xs) - 64.0, min(ys) - 64.0), (max(xs) + 64.0, min(ys) - 64.0),
+              (max(xs) + 64.0, max(ys) + 64.0), (min(xs) - 64.0, max(ys) + 64.0)]
+
+    stack = [(len(m.nodes) - 1 if m.nodes else NF_SUBSECTOR, bounds)]
+    while stack:
+        num, poly = stack.pop()
+
+        if num & NF_SUBSECTOR:
+            num &= ~NF_SUBSECTOR
+            numsegs, firstseg = m.subsectors[num]
+            for seg in m.segs[firstseg:firstseg + numsegs]:
+                if len(poly) < 3:
+                    break
+                ox, oy, dx, dy = m.seg_line(seg)
+                if dx or dy:
+                    poly = clip_polygon(poly, ox, oy, dx, dy, False)
+
+            if len(poly) >= 3 and abs(polygon_area(poly)) > MIN_WINDOW:
+                polygons[num] = poly
+            continue
+
+        node = m.nodes[num]
+        ox, oy, dx, dy = map(float, node[0:4])
+        stack.append((node[12], clip_polygon(poly, ox, oy, dx, dy, False)))
+        stack.append((node[13], clip_polygon(poly, ox, oy, dx, dy, True)))
+
+    return polygons
+
+
+# Parts of the edges of a subsector that are not covered by one-sided segs
+def open_edges(m, num, poly):
+    numsegs, firstseg = m.subsectors[num]
+    walls = [m.seg_line(seg) for seg in m.segs[firstseg:firstseg + numsegs] if m.seg_blocks(seg)]
+    edges = []
+
+    for i in range(len(poly)):
+        x1, y1 = poly[i]
+        x2, y2 = poly[(i + 1) % len(poly)]
+        ex = x2 - x1
+        ey = y2 - y1
+        length2 = ex * ex + ey * ey
+        if length2 < MIN_WINDOW * MIN_WINDOW:
+            continue
+
+        length = math.sqrt(length2)
+        intervals = [(0.0, 1.0)]
+
+        for ox, oy, dx, dy in walls:
+            # Wall along this edge?
+            if abs(side(x1, y1, ex, ey, ox, oy)) / length > EPSILON or \
+               abs(side(x1, y1, ex, ey, ox + dx, oy + dy)) / length > EPSILON:
+                continue
+
+            t1 = ((ox - x1) * ex + (oy - y1) * ey) / length2
+            t2 = ((ox + dx - x1) * ex + (oy + dy - y1) * ey) / length2
+            t1, t2 = min(t1, t2), max(t1, t2)
+
+            remaining = []
+            for a, b in intervals:
+                if t2 <= a or t1 >= b:
+                    remaining.append((a, b))
+                    continue
+                if t1 > a:
+                    remaining.append((a, t1))
+                if t2 < b:
+                    remaining.append((t2, b))
+            intervals = remaining
+
+        for a, b in intervals:
+            if (b - a) * length > MIN_WINDOW:
+                edges.append(((x1 + ex * a, y1 + ey * a), (x1 + ex * b, y1 + ey * b)))
+
+    return edges
+
+
+# Part of an edge that lies within margin of a convex polygon
+def edge_overlap(edge, poly, margin):
+    a, b = edge
+    orientation = 1.0 if polygon_area(poly) > 0 else -1.0
+
+    for i in range(len(poly)):
+        c = poly[i]
+        d = poly[(i + 1) % len(poly)]
+        dx = d[0] - c[0]
+        dy = d[1] - c[1]
+        length = math.hypot(dx, dy)
+        if length < MIN_WINDOW:
+            continue
+
+        # Distance inside the polygon, the edges are moved out by margin
+        sa = side(c[0], c[1], dx, dy, a[0], a[1]) * orientation / length + margin
+        sb = side(c[0], c[1], dx, dy, b[0], b[1]) * orientation / length + margin
+
+        if sa < 0 and sb < 0:
+            return None
+        if sa < 0 or sb < 0:
+            t = sa / (sa - sb)
+            cut = (a[0] + (b[0] - a[0]) * t, a[1] + (b[1] - a[1]) * t)
+            if sa < 0:
+                a = cut
+            else:
+                b = cut
+
+    if math.hypot(b[0] - a[0], b[1] - a[1]) < MIN_WINDOW:
+        return None
+
+    return (a, b)
+
+
+def bounding_box(points):
+    xs = [p[0] for p in points]
+    ys = [p[1] for p in points]
+    return (min(xs) - EPSILON, min(ys) - EPSILON, max(xs) + EPSILON, max(ys) + EPSILON)
+
+
+def boxes_overlap(a, b):
+    return a[0] <= b[2] and b[0] <= a[2] and a[1] <= b[3] and b[1] <= a[3]
+
+
+class Portal:
+    def __init__(self, a, b, leaf, neighbour, centre):
+        self.a = a
+        self.b = b
+        self.leaf = leaf
+        self.neighbour = neighbour
+        self.flood = 0
+
+        # Sign of the side facing the neighbour
+        self.front = -1.0 if side(a[0], a[1], b[0] - a[0], b[1] - a[1], centre[0], centre[1]) > 0 else 1.0
+
+    def in_front(self, point):
+        return side(self.a[0], self.a[1], self.b[0] - self.a[0], self.b[1] - self.a[1],
+                    point[0], point[1]) * self.front > MIN_WINDOW
+
+
+# Every open edge becomes a portal to each subsector touching it. The
+# window is the part of the edge close to the other subsector, so it is
+# still found when rounded vertices make the polygons not line up exactly.
+def build_portals(m, polygons):
+    portals = [[] for _ in polygons]
+    boxes = [bounding_box(poly) if poly else None for poly in polygons]
+
+    for num, poly in enumerate(polygons):
+        if poly is None:
+            continue
+
+        centre = (sum(p[0] for p in poly) / len(poly), sum(p[1] for p in poly) / len(poly))
+
+        for edge in open_edges(m, num, poly):
+            box = bounding_box(edge)
+            for other, otherpoly in enumerate(polygons):
+                if other == num or otherpoly is None or not boxes_overlap(box, boxes[other]):
+                    continue
+                window = edge_overlap(edge, otherpoly, EPSILON)
+                if window is None:
+                    continue
+
+                # Subsectors that only touch a corner of the edge
+                if math.hypot(window[1][0] - window[0][0], window[1][1] - window[0][1]) <= 3 * EPSILON and \
+                   edge_overlap(edge, otherpoly, MIN_WINDOW) is None:
+                    continue
+
+                portals[num].append(Portal(window[0], window[1], num, other, centre))
+
+    return portals
+
+
+# Coarse set of the subsectors that could be seen through a portal. A
+# line of sight crossing it can only go on through portals that are partly
+# in front of it, and that have it partly behind them.
+def flood_portals(portals):
+    for leafportals in portals:
+        for portal in leafportals:
+            flood = 1 << portal.neighbour
+            stack = [portal.neighbour]
+
+            while stack:
+                for other in portals[stack.pop()]:
+                    if (flood >> other.neighbour) & 1:
+                        continue
+                    if not portal.in_front(other.a) and not portal.in_front(other.b):
+                        continue
+                    if other.in_front(portal.a) and other.in_front(portal.b):
+                        continue
+
+                    flood |= 1 << other.neighbour
+                    stack.append(other.neighbour)
+
+            portal.flood = flood
+
+
+# Lines through an end of the source and an end of the pass window that
+# leave both windows on opposite sides. Whatever can be seen through both
+# windows lies on the pass side of all of them.
+def separators(source, passwindow):
+    result = []
+
+    for o, so in (source, source[::-1]):
+        ox, oy = o
+        sx = so[0] - ox
+        sy = so[1] - oy
+
+        for p, po in (passwindow, passwindow[::-1]):
+            dx = p[0] - ox
+            dy = p[1] - oy
+            if dx * dx + dy * dy < MIN_WINDOW * MIN_WINDOW:
+                continue
+
+            s = dx * sy - dy * sx
+            t = dx * (po[1] - oy) - dy * (po[0] - ox)
+
+            if (s < -MIN_WINDOW and t > MIN_WINDOW) or (s > MIN_WINDOW and t < -MIN_WINDOW):
+                if t > 0:
+                    result.append((ox, oy, dx, dy))
+                else:
+                    result.append((ox, oy, -dx, -dy))
+
+    return result
+
+
+# Keeps the part of a window on the left of all the separators
+def clip_window(window, seps):
+    (ax, ay), (bx, by) = window
+
+    for ox, oy, dx, dy in seps:
+        sa = dx * (ay - oy) - dy * (ax - ox)
+        sb = dx * (by - oy) - dy * (bx - ox)
+
+        if sa < 0:
+            if sb < 0:
+                return None
+            t = sa / (sa - sb)
+            ax += (bx - ax) * t
+            ay += (by - ay) * t
+        elif sb < 0:
+            t = sa / (sa - sb)
+            bx = ax + (bx - ax) * t
+            by = ay + (by - ay) * t
+
+    if (bx - ax) * (bx - ax) + (by - ay) * (by - ay) < MIN_WINDOW * MIN_WINDOW:
+        return None
+
+    return ((ax, ay), (bx, by))
+
+
+# Position of a point along a window, 0 at a and 1 at b
+def window_position(window, point):
+    a, b = window
+    dx = b[0] - a[0]
+    dy = b[1] - a[1]
+    return ((point[0] - a[0]) * dx + (point[1] - a[1]) * dy) / (dx * dx + dy * dy)
+
+
+# Smallest interval of line holding both windows that lie on it
+def merge_windows(line, old, new):
+    if old is None:
+        return new, True
+
+    ta = [window_position(line, p) for p in old + new]
+    low = min(ta)
+    high = max(ta)
+
+    oldlow = min(ta[0], ta[1])
+    oldhigh = max(ta[0], ta[1])
+    if low >= oldlow - 1e-6 and high <= oldhigh + 1e-6:
+        return old, False
+
+    a, b = line
+    return ((a[0] + (b[0] - a[0]) * low, a[1] + (b[1] - a[1]) * low),
+            (a[0] + (b[0] - a[0]) * high, a[1] + (b[1] - a[1]) * high)), True
+
+
+# Subsectors seen through the portals of a subsector. Every portal is
+# crossed with the widest windows found so far, merging the windows of
+# different paths. Merged windows only add lines of sight, so the result
+# stays conservative and each portal is only walked again when its
+# windows grow.
+def flow_subsector(portals, num):
+    visible = 1 << num
+
+    for start in portals[num]:
+        visible |= 1 << start.neighbour
+
+        startwindow = (start.a, start.b)
+        windows = {}
+        sources = {}
+        walks = {}
+        work = deque([(start.neighbour, startwindow, startwindow)])
+
+        while work:
+            leaf, source, passwindow = work.popleft()
+            seps = separators(source, passwindow)
+
+            for portal in portals[leaf]:
+                neighbour = portal.neighbour
+
+                # Nothing new can be found behind this portal
+                if not portal.flood & ~visible:
+                    continue
+
+                window = clip_window((portal.a, portal.b), seps)
+                if window is None:
+                    continue
+
+                visible |= 1 << neighbour
+
+                # Only the part of the source that sees the new window
+                # matters from now on
+                narrowed = clip_window(source, separators(window, passwindow))
+                if narrowed is None:
+                    continue
+
+                window, wider = merge_windows((portal.a, portal.b), windows.get(portal), window)
+                narrowed, widersource = merge_windows(startwindow, sources.get(portal), narrowed)
+                if not wider and not widersource:
+                    continue
+
+                # Windows that keep growing are opened fully, so that no
+                # portal is walked more than a few times
+                walks[portal] = walks.get(portal, 0) + 1
+                if walks[portal] > MAX_WALKS:
+                    if walks[portal] > MAX_WALKS + 1:
+                        continue
+                    window = (portal.a, portal.b)
+                    narrowed = startwindow
+
+                windows[portal] = window
+                sources[portal] = narrowed
+                work.append((neighbour, narrowed, window))
+
+    return visible
+
+
+def build_pvs(m):
+    polygons = build_polygons(m)
+    portals = build_portals(m, polygons)
+    flood_portals(portals)
+
+    count = len(polygons)
+    everything = (1 << count) - 1
+    degenerate = 0
+    rows = []
+
+    for num in range(count):
+        if polygons[num] is None:
+            degenerate |= 1 << num
+
+    for num in range(count):
+        if polygons[num] is None:
+            rows.append(everything)
+        else:
+            # Degenerate subsectors can't be placed, keep them always visible
+            rows.append(flow_subsector(portals, num) | degenerate)
+
+    return rows
+
+
+def compress_row(visible, count):
+    bits = bytearray(visible.to_bytes((count + 7) >> 3, "little"))
+
+    result = bytearray()
+    i = 0
+    while i < len(bits):
+        if bits[i]:
+            result.append(bits[i])
+            i += 1
+            continue
+
+        run = 0
+        while i < len(bits) and not bits[i] and run < 255:
+            run += 1
+            i += 1
+        result += bytes((0, run))
+
+    return bytes(result)
+
+
+def pvs_lump(rows):
+    count = len(rows)
+    offset = 4 + 4 * count
+    offsets = []
+    data = b""
+
+    for row in rows:
+        compressed = compress_row(row, count)
+        offsets.append(offset + len(data))
+        data += compressed
+
+    return struct.pack("<i", count) + struct.pack("<%di" % count, *offsets) + data
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("Usage: python fastdoom_pvs.py input.wad output.wad [map ...]")
+        sys.exit(1)
+
+    maps = find_maps(read_wad(sys.argv[1]))
+    names = [name.upper() for name in sys.argv[3:]] or sorted(maps)
+    output = []
+
+    for name in names:
+        if name not in maps:
+            print(name + " not found")
+            continue
+
+        rows = build_pvs(Map(maps[name]))
+        visible = sum(bin(row).count("1") for row in rows)
+        print("%s: %d subsectors, %.1f%% visible on average" %
+              (name, len(rows), 100.0 * visible / max(1, len(rows) * len(rows))))
+
+        output.append(("PVS" + name, pvs_lump(rows)))
+
+    write_wad(sys.argv[2], output)
+    print("Written " + sys.argv[2])
+
+
+if __name__ == "__main__":
+    main()